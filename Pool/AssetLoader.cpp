@@ -0,0 +1,110 @@
+#include "AssetLoader.hpp"
+
+#include "cs488-framework/TraceRecorder.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+AssetLoader::AssetLoader(size_t numThreads)
+  : m_numLoaded(0),
+    m_isStopping(false)
+{
+  if (numThreads == 0) {
+    numThreads = std::max(1u, thread::hardware_concurrency());
+  }
+
+  for (size_t i = 0; i < numThreads; i++) {
+    m_threads.push_back(thread(&AssetLoader::workerLoop, this));
+  }
+}
+
+//----------------------------------------------------------------------------------------
+AssetLoader::~AssetLoader() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_isStopping = true;
+  }
+  m_wakeWorkers.notify_all();
+
+  for (thread & worker : m_threads) {
+    worker.join();
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void AssetLoader::load(const Task & decode, const Task & upload) {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    Asset asset;
+    asset.decode = decode;
+    asset.upload = upload;
+    m_assets.push_back(asset);
+    m_toDecode.push_back(m_assets.size() - 1);
+  }
+  m_wakeWorkers.notify_one();
+}
+
+//----------------------------------------------------------------------------------------
+void AssetLoader::finish(const ProgressCallback & progress) {
+  unique_lock<mutex> lock(m_mutex);
+
+  while (m_numLoaded < m_assets.size()) {
+    m_assetDecoded.wait(lock, [this] { return ! m_toUpload.empty(); });
+    size_t index = m_toUpload.front();
+    m_toUpload.pop_front();
+
+    // Upload without the lock, so workers can keep going and the upload can
+    // queue more assets
+    Asset & asset = m_assets[index];
+    lock.unlock();
+    if (asset.exception) {
+      rethrow_exception(asset.exception);
+    }
+    asset.upload();
+    asset = Asset(); // free whatever the tasks captured
+
+    lock.lock();
+    m_numLoaded++;
+    if (progress) {
+      size_t numLoaded = m_numLoaded;
+      size_t numAssets = m_assets.size();
+      lock.unlock();
+      progress(numLoaded, numAssets);
+      lock.lock();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void AssetLoader::workerLoop() {
+  TraceRecorder::get().setThreadName("AssetLoader");
+  unique_lock<mutex> lock(m_mutex);
+
+  while (true) {
+    m_wakeWorkers.wait(lock, [this] {
+      return m_isStopping || ! m_toDecode.empty();
+    });
+    if (m_isStopping) {
+      return;
+    }
+
+    size_t index = m_toDecode.front();
+    m_toDecode.pop_front();
+    Asset & asset = m_assets[index];
+    lock.unlock();
+
+    try {
+      TRACE_SCOPE("decode");
+      asset.decode();
+    }
+    catch (...) {
+      asset.exception = current_exception();
+    }
+
+    lock.lock();
+    m_toUpload.push_back(index);
+    m_assetDecoded.notify_one();
+  }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+  Loads assets on worker threads while the calling (GL) thread uploads them.
+
+  Each asset is split in two: decode, which reads and parses files and must
+  not touch GL, runs on a worker; upload, which hands the result to GL, runs on
+  the thread calling finish(), as soon as that asset's decode returns. Uploads
+  may queue further assets, e.g. the textures named by a freshly decoded scene.
+*/
+class AssetLoader {
+  public:
+    typedef std::function<void()> Task;
+    // Called on the finish() thread after each upload
+    typedef std::function<void(size_t numLoaded, size_t numAssets)> ProgressCallback;
+
+    // Start numThreads workers; 0 uses one per hardware thread
+    explicit AssetLoader(size_t numThreads = 0);
+    ~AssetLoader();
+
+    // Queue an asset; its decode may start right away
+    void load(const Task & decode, const Task & upload);
+
+    /*
+      Run uploads as decodes finish, until every asset queued so far, or by
+      the uploads themselves, is loaded. If a decode throws, the exception is
+      rethrown here when its upload would have run.
+    */
+    void finish(const ProgressCallback & progress = ProgressCallback());
+
+  protected:
+    struct Asset {
+      Task decode;
+      Task upload;
+      std::exception_ptr exception;
+    };
+
+    void workerLoop();
+
+    std::vector<std::thread> m_threads;
+
+    // Guards everything below
+    std::mutex m_mutex;
+    std::condition_variable m_wakeWorkers;
+    std::condition_variable m_assetDecoded;
+    std::deque<Asset> m_assets; // stable addresses while growing at the back
+    std::deque<size_t> m_toDecode;
+    std::deque<size_t> m_toUpload;
+    size_t m_numLoaded;
+    bool m_isStopping;
+
+    AssetLoader(const AssetLoader &);
+    AssetLoader & operator=(const AssetLoader &);
+};
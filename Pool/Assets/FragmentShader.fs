@@ -21,8 +21,14 @@ struct Material {
 };
 uniform Material material;
 
-// Ambient light intensity for each RGB component.
-uniform vec3 ambientIntensity;
+// Per-frame scene state, shared by every program (see Pool::SceneUniforms)
+layout(std140) uniform SceneUniforms {
+	mat4 Perspective;
+	mat4 View;
+	vec4 lightPosition;
+	vec4 lightRgbIntensity;
+	vec4 ambientIntensity; // Ambient light intensity for each RGB component.
+};
 
 
 vec3 phongModel(vec3 fragPosition, vec3 fragNormal) {
@@ -49,7 +55,7 @@ vec3 phongModel(vec3 fragPosition, vec3 fragNormal) {
         specular = material.ks * pow(n_dot_h, material.shininess);
     }
 
-    return ambientIntensity + light.rgbIntensity * (diffuse + specular);
+    return ambientIntensity.rgb + light.rgbIntensity * (diffuse + specular);
 }
 
 void main() {
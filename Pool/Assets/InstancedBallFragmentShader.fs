@@ -0,0 +1,66 @@
+#version 330
+
+struct LightSource {
+    vec3 position;
+    vec3 rgbIntensity;
+};
+
+struct Material {
+    vec3 kd;
+    vec3 ks;
+    float shininess;
+};
+
+in VsOutFsIn {
+	vec3 position_ES; // Eye-space position
+	vec3 normal_ES;   // Eye-space normal
+	LightSource light;
+	flat vec3 kd;
+	flat vec3 ks;
+	flat float shininess;
+} fs_in;
+
+
+out vec4 fragColour;
+
+// Per-frame scene state, shared by every program (see Pool::SceneUniforms)
+layout(std140) uniform SceneUniforms {
+	mat4 Perspective;
+	mat4 View;
+	vec4 lightPosition;
+	vec4 lightRgbIntensity;
+	vec4 ambientIntensity; // Ambient light intensity for each RGB component.
+};
+
+
+vec3 phongModel(vec3 fragPosition, vec3 fragNormal) {
+	LightSource light = fs_in.light;
+	Material material = Material(fs_in.kd, fs_in.ks, fs_in.shininess);
+
+    // Direction from fragment to light source.
+    vec3 l = normalize(light.position - fragPosition);
+
+    // Direction from fragment to viewer (origin - fragPosition).
+    vec3 v = normalize(-fragPosition.xyz);
+
+    float n_dot_l = max(dot(fragNormal, l), 0.0);
+
+	vec3 diffuse;
+	diffuse = material.kd * n_dot_l;
+
+    vec3 specular = vec3(0.0);
+
+    if (n_dot_l > 0.0) {
+		// Halfway vector.
+		vec3 h = normalize(v + l);
+        float n_dot_h = max(dot(fragNormal, h), 0.0);
+
+        specular = material.ks * pow(n_dot_h, material.shininess);
+    }
+
+    return ambientIntensity.rgb + light.rgbIntensity * (diffuse + specular);
+}
+
+void main() {
+	fragColour = vec4(phongModel(fs_in.position_ES, fs_in.normal_ES), 1.0);
+}
@@ -0,0 +1,51 @@
+#version 330
+
+// Model-Space coordinates
+in vec3 position;
+in vec3 normal;
+
+// Per-instance attributes, one set per ball
+in mat4 model;
+in vec3 kd;
+in vec3 ks;
+in float shininess;
+
+struct LightSource {
+    vec3 position;
+    vec3 rgbIntensity;
+};
+
+// Per-frame scene state, shared by every program (see Pool::SceneUniforms)
+layout(std140) uniform SceneUniforms {
+	mat4 Perspective;
+	mat4 View;
+	vec4 lightPosition;
+	vec4 lightRgbIntensity;
+	vec4 ambientIntensity; // Ambient light intensity for each RGB component.
+};
+
+out VsOutFsIn {
+	vec3 position_ES; // Eye-space position
+	vec3 normal_ES;   // Eye-space normal
+	LightSource light;
+	flat vec3 kd;
+	flat vec3 ks;
+	flat float shininess;
+} vs_out;
+
+
+void main() {
+	vec4 pos4 = vec4(position, 1.0);
+	mat4 modelView = View * model;
+
+	//-- Convert position and normal to Eye-Space:
+	vs_out.position_ES = (modelView * pos4).xyz;
+	vs_out.normal_ES = normalize(transpose(inverse(mat3(modelView))) * normal);
+
+	vs_out.light = LightSource(lightPosition.xyz, lightRgbIntensity.xyz);
+	vs_out.kd = kd;
+	vs_out.ks = ks;
+	vs_out.shininess = shininess;
+
+	gl_Position = Perspective * modelView * pos4;
+}
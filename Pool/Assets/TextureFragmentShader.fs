@@ -22,13 +22,21 @@ struct Material {
 };
 uniform Material material;
 
-// Ambient light intensity for each RGB component.
-uniform vec3 ambientIntensity;
+// Per-frame scene state, shared by every program (see Pool::SceneUniforms)
+layout(std140) uniform SceneUniforms {
+	mat4 Perspective;
+	mat4 View;
+	vec4 lightPosition;
+	vec4 lightRgbIntensity;
+	vec4 ambientIntensity; // Ambient light intensity for each RGB component.
+};
 
 // Texture =================================================================
 
 // Values that stay constant for the whole mesh.
-uniform sampler2D textureSampler;
+// Every texture is a layer of an array, shared with textures of the same size
+uniform sampler2DArray textureSampler;
+uniform int textureLayer;
 
 // END (Texture) ===========================================================
 
@@ -57,12 +65,12 @@ vec3 phongModel(vec3 fragPosition, vec3 fragNormal, vec3 textureColor) {
         specular = material.ks * pow(n_dot_h, material.shininess);
     }
 
-    return ambientIntensity + light.rgbIntensity * (diffuse + specular);
+    return ambientIntensity.rgb + light.rgbIntensity * (diffuse + specular);
 }
 
 void main() {
   // colour of the texture at the specified UV
-  vec3 textureColor = texture(textureSampler, fs_in.textureUV).rgb;
+  vec3 textureColor = texture(textureSampler, vec3(fs_in.textureUV, textureLayer)).rgb;
 	fragColour = vec4( phongModel( fs_in.position_ES,
 	                               fs_in.normal_ES,
 	                               textureColor
@@ -8,10 +8,17 @@ struct LightSource {
     vec3 position;
     vec3 rgbIntensity;
 };
-uniform LightSource light;
+
+// Per-frame scene state, shared by every program (see Pool::SceneUniforms)
+layout(std140) uniform SceneUniforms {
+	mat4 Perspective;
+	mat4 View;
+	vec4 lightPosition;
+	vec4 lightRgbIntensity;
+	vec4 ambientIntensity; // Ambient light intensity for each RGB component.
+};
 
 uniform mat4 ModelView;
-uniform mat4 Perspective;
 
 // Remember, this is transpose(inverse(ModelView)).  Normals should be
 // transformed using this matrix instead of the ModelView matrix.
@@ -31,7 +38,7 @@ void main() {
 	vs_out.position_ES = (ModelView * pos4).xyz;
 	vs_out.normal_ES = normalize(NormalMatrix * normal);
 
-	vs_out.light = light;
+	vs_out.light = LightSource(lightPosition.xyz, lightRgbIntensity.xyz);
 
 	gl_Position = Perspective * ModelView * vec4(position, 1.0);
 }
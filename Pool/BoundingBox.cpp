@@ -0,0 +1,65 @@
+#include "BoundingBox.hpp"
+
+#include <limits>
+
+using namespace glm;
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+BoundingBox::BoundingBox()
+	: min(numeric_limits<float>::max()),
+	  max(- numeric_limits<float>::max())
+{}
+
+//----------------------------------------------------------------------------------------
+bool BoundingBox::isEmpty() const {
+	return min.x > max.x;
+}
+
+//----------------------------------------------------------------------------------------
+void BoundingBox::expand(const vec3 & point) {
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+//----------------------------------------------------------------------------------------
+void BoundingBox::expand(const BoundingBox & box) {
+	if (! box.isEmpty()) {
+		expand(box.min);
+		expand(box.max);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * The transformed extents along each axis are the sum of the extents along
+ * each original axis, projected onto it (Arvo's method).
+ */
+BoundingBox BoundingBox::transformed(const mat4 & transform) const {
+	if (isEmpty()) {
+		return *this;
+	}
+
+	vec3 center = vec3(transform * vec4(getCenter(), 1.0f));
+	mat3 linear(transform);
+	vec3 extents = vec3(0.0f);
+	vec3 original = getExtents();
+	for (int axis = 0; axis < 3; axis++) {
+		extents += abs(linear[axis]) * original[axis];
+	}
+
+	BoundingBox box;
+	box.min = center - extents;
+	box.max = center + extents;
+	return box;
+}
+
+//----------------------------------------------------------------------------------------
+vec3 BoundingBox::getCenter() const {
+	return (min + max) * 0.5f;
+}
+
+//----------------------------------------------------------------------------------------
+vec3 BoundingBox::getExtents() const {
+	return (max - min) * 0.5f;
+}
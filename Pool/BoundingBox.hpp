@@ -0,0 +1,23 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/*
+ * Axis-aligned bounding box. Starts out empty, and grows to cover the points
+ * and boxes added to it.
+ */
+struct BoundingBox {
+	BoundingBox();
+
+	bool isEmpty() const;
+	void expand(const glm::vec3 & point);
+	void expand(const BoundingBox & box);
+	// Smallest axis-aligned box covering this one after the transform
+	BoundingBox transformed(const glm::mat4 & transform) const;
+
+	glm::vec3 getCenter() const;
+	glm::vec3 getExtents() const; // half the size along each axis
+
+	glm::vec3 min;
+	glm::vec3 max;
+};
@@ -1,5 +1,5 @@
 #include "Camera.hpp"
-#include "floats.hpp"
+#include "physics/floats.hpp"
 #include "RangeClamp.hpp"
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "RangeClamp.hpp"
-#include "Ray.hpp"
+#include "physics/Ray.hpp"
 
 #include <glm/glm.hpp>
 
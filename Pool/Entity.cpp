@@ -1,5 +0,0 @@
-#include "Entity.hpp"
-
-Entity::Entity(EntityType type, std::string name)
-  : m_type(type), m_name(name)
-{}
@@ -0,0 +1,58 @@
+#include "Frustum.hpp"
+
+using namespace glm;
+
+//----------------------------------------------------------------------------------------
+Frustum::Frustum() {
+	// Accepts everything
+	for (vec4 & plane : m_planes) {
+		plane = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * A point p is inside the clip volume when -w <= x, y, z <= w for
+ * (x, y, z, w) = M * p, so each plane is the last row of M plus or minus
+ * one of the others (Gribb and Hartmann).
+ */
+Frustum::Frustum(const mat4 & viewProjection) {
+	mat4 rows = transpose(viewProjection);
+	for (int axis = 0; axis < 3; axis++) {
+		m_planes[2 * axis] = rows[3] + rows[axis];
+		m_planes[2 * axis + 1] = rows[3] - rows[axis];
+	}
+	for (vec4 & plane : m_planes) {
+		plane /= length(vec3(plane));
+	}
+}
+
+//----------------------------------------------------------------------------------------
+Frustum::Containment Frustum::classify(const BoundingBox & box) const {
+	if (box.isEmpty()) {
+		return INSIDE;
+	}
+
+	vec3 center = box.getCenter();
+	vec3 extents = box.getExtents();
+	Containment result = INSIDE;
+	for (const vec4 & plane : m_planes) {
+		vec3 normal = vec3(plane);
+		// Distance of the center from the plane, and how far the box reaches
+		// towards it
+		float distance = dot(normal, center) + plane.w;
+		float radius = dot(abs(normal), extents);
+		if (distance < - radius) {
+			return OUTSIDE;
+		}
+		if (distance < radius) {
+			result = INTERSECTING;
+		}
+	}
+	return result;
+}
+
+//----------------------------------------------------------------------------------------
+bool Frustum::intersects(const BoundingBox & box) const {
+	return classify(box) != OUTSIDE;
+}
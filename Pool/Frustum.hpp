@@ -0,0 +1,27 @@
+#pragma once
+
+#include "BoundingBox.hpp"
+
+#include <glm/glm.hpp>
+
+/*
+ * The volume a camera sees, as six inward-facing planes, for culling whatever
+ * lies entirely outside it.
+ */
+class Frustum {
+public:
+	enum Containment { OUTSIDE, INTERSECTING, INSIDE };
+
+	Frustum();
+	// Extract the planes of the clip volume of projection * view
+	explicit Frustum(const glm::mat4 & viewProjection);
+
+	// Conservative: boxes near a corner of the frustum may be reported as
+	// INTERSECTING though they are outside. Empty boxes are INSIDE, so that
+	// whatever has no bounds is never culled.
+	Containment classify(const BoundingBox & box) const;
+	bool intersects(const BoundingBox & box) const;
+
+private:
+	glm::vec4 m_planes[6]; // (normal, distance); normals point inward
+};
@@ -12,9 +12,6 @@ GeometryNode::GeometryNode(
 }
 
 GeometryNode::~GeometryNode() {
-  if (isTextured() && textureData != NULL) {
-    delete textureData;
-  }
 }
 
 bool GeometryNode::isTextured() const {
@@ -17,10 +17,10 @@ public:
 
 	Material material;
 	std::vector<std::string> textureFiles;
+	// Shared texture ids, owned by the TextureManager
 	std::vector<GLuint> textureIds;
-	unsigned char * textureData;
-	unsigned int textureWidth;
-	unsigned int textureHeight;
+	// World-space bounds of the mesh alone, cached by Pool::updateBounds()
+	mutable BoundingBox meshBounds;
 
 	// Mesh Identifier. This must correspond to an object name of
 	// a loaded .obj file.
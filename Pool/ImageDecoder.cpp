@@ -0,0 +1,351 @@
+#include "ImageDecoder.hpp"
+
+#include <lodepng/lodepng.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+// Largest width or height accepted, to keep sizes from overflowing
+static const unsigned int MAX_IMAGE_SIZE = 16384;
+
+static const unsigned int BI_RGB = 0;
+static const unsigned int BI_BITFIELDS = 3;
+static const unsigned int BI_ALPHABITFIELDS = 6;
+
+//----------------------------------------------------------------------------------------
+// Little-endian reads, safe for unaligned data
+static unsigned int readU16(const unsigned char * data) {
+  return data[0] | (data[1] << 8);
+}
+
+static unsigned int readU32(const unsigned char * data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+}
+
+//----------------------------------------------------------------------------------------
+// A bitfield mask of a BMP pixel, and how to widen its value to 8 bits
+struct ChannelMask {
+  unsigned int mask;
+  unsigned int shift;
+  unsigned int maxValue;
+
+  ChannelMask(unsigned int mask = 0)
+    : mask(mask), shift(0), maxValue(0)
+  {
+    if (mask == 0) {
+      return;
+    }
+    while (((mask >> shift) & 1) == 0) {
+      shift++;
+    }
+    maxValue = mask >> shift;
+  }
+
+  unsigned char extract(unsigned int pixel, unsigned char missing) const {
+    if (maxValue == 0) {
+      return missing;
+    }
+    unsigned int value = (pixel & mask) >> shift;
+    return (unsigned char)((value * 255u + maxValue / 2) / maxValue);
+  }
+};
+
+//----------------------------------------------------------------------------------------
+unsigned int Image::channels() const {
+  return format == PixelFormat::RGBA || format == PixelFormat::BGRA ? 4 : 3;
+}
+
+//----------------------------------------------------------------------------------------
+bool ImageDecoder::decode(const std::string & filePath, Image & out_image) {
+  FILE * file = fopen(filePath.c_str(), "rb");
+  if (! file) {
+    return fail(filePath, "could not be opened");
+  }
+
+  unsigned char magic[8];
+  size_t numRead = fread(magic, 1, sizeof(magic), file);
+  rewind(file);
+
+  m_error.clear();
+  bool isDecoded;
+  if (numRead >= 2 && magic[0] == 'B' && magic[1] == 'M') {
+    isDecoded = decodeBMP(file, out_image);
+  }
+  else if (numRead == 8 && memcmp(magic, "\x89PNG\r\n\x1a\n", 8) == 0) {
+    isDecoded = decodePNG(file, out_image);
+  }
+  else {
+    m_error = "is not a BMP or PNG file";
+    isDecoded = false;
+  }
+  fclose(file);
+
+  if (! isDecoded) {
+    return fail(filePath, m_error.c_str());
+  }
+  out_image.filePath = filePath;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+bool ImageDecoder::decodeBMP(FILE * file, Image & out_image) {
+  // File header, and the largest info header (BITMAPV5HEADER)
+  unsigned char header[14 + 124];
+  memset(header, 0, sizeof(header));
+  if (fread(header, 1, 18, file) != 18) {
+    m_error = "has a truncated header";
+    return false;
+  }
+  unsigned int dataOffset = readU32(header + 10);
+  unsigned int infoSize = readU32(header + 14);
+  if (infoSize != 12 && (infoSize < 40 || infoSize > 124)) {
+    m_error = "has an unsupported BMP header";
+    return false;
+  }
+  if (fread(header + 18, 1, infoSize - 4, file) != infoSize - 4) {
+    m_error = "has a truncated header";
+    return false;
+  }
+  const unsigned char * info = header + 14;
+
+  long width, height;
+  unsigned int bitsPerPixel;
+  unsigned int compression = BI_RGB;
+  unsigned int numColours = 0;
+  unsigned int paletteEntrySize = 4;
+  if (infoSize == 12) {
+    // BITMAPCOREHEADER
+    width = readU16(info + 4);
+    height = (short)readU16(info + 6);
+    bitsPerPixel = readU16(info + 10);
+    paletteEntrySize = 3;
+  }
+  else {
+    width = (int)readU32(info + 4);
+    height = (int)readU32(info + 8);
+    bitsPerPixel = readU16(info + 14);
+    compression = readU32(info + 16);
+    numColours = readU32(info + 32);
+  }
+
+  bool isTopDown = height < 0;
+  if (isTopDown) {
+    height = -height;
+  }
+  if ( width <= 0 || height <= 0 ||
+       width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE )
+  {
+    m_error = "has an invalid size";
+    return false;
+  }
+
+  // Bitfield masks follow a plain BITMAPINFOHEADER, or are part of later ones
+  unsigned int masks[4] = { 0, 0, 0, 0 };
+  size_t paletteOffset = 14 + infoSize;
+  if (compression == BI_BITFIELDS || compression == BI_ALPHABITFIELDS) {
+    size_t numMasks = compression == BI_ALPHABITFIELDS ? 4 : 3;
+    if (infoSize == 40) {
+      unsigned char maskData[16];
+      if (fread(maskData, 4, numMasks, file) != numMasks) {
+        m_error = "has truncated bitfields";
+        return false;
+      }
+      for (size_t i = 0; i < numMasks; i++) {
+        masks[i] = readU32(maskData + 4 * i);
+      }
+      paletteOffset += 4 * numMasks;
+    }
+    else {
+      for (size_t i = 0; i < 4 && 40 + 4 * i < infoSize; i++) {
+        masks[i] = readU32(info + 40 + 4 * i);
+      }
+    }
+  }
+  else if (compression != BI_RGB) {
+    m_error = "is compressed, which isn't supported";
+    return false;
+  }
+  else if (bitsPerPixel == 16) {
+    // X1R5G5B5
+    masks[0] = 0x7c00;
+    masks[1] = 0x03e0;
+    masks[2] = 0x001f;
+  }
+
+  // Palette, as RGB
+  unsigned char palette[256 * 3];
+  bool isPalettized = bitsPerPixel <= 8;
+  if (isPalettized) {
+    if (bitsPerPixel != 1 && bitsPerPixel != 4 && bitsPerPixel != 8) {
+      m_error = "has an unsupported bit depth";
+      return false;
+    }
+    unsigned int maxColours = 1u << bitsPerPixel;
+    if (numColours == 0 || numColours > maxColours) {
+      numColours = maxColours;
+    }
+    unsigned char entries[256 * 4];
+    memset(palette, 0, sizeof(palette));
+    if ( fseek(file, long(paletteOffset), SEEK_SET) != 0 ||
+         fread(entries, paletteEntrySize, numColours, file) != numColours )
+    {
+      m_error = "has a truncated palette";
+      return false;
+    }
+    for (unsigned int i = 0; i < numColours; i++) {
+      const unsigned char * entry = entries + i * paletteEntrySize;
+      palette[3 * i + 0] = entry[2];
+      palette[3 * i + 1] = entry[1];
+      palette[3 * i + 2] = entry[0];
+    }
+  }
+  else if (bitsPerPixel != 16 && bitsPerPixel != 24 && bitsPerPixel != 32) {
+    m_error = "has an unsupported bit depth";
+    return false;
+  }
+
+  // Pick the output format; 24 and 32 bit rows are copied as they are
+  bool hasMasks = masks[0] | masks[1] | masks[2];
+  bool isCopied = ! hasMasks && (bitsPerPixel == 24 || bitsPerPixel == 32);
+  if (isCopied) {
+    out_image.format = PixelFormat::BGR;
+  }
+  else if (masks[3] != 0) {
+    out_image.format = PixelFormat::RGBA;
+  }
+  else {
+    out_image.format = PixelFormat::RGB;
+  }
+  ChannelMask red(masks[0]), green(masks[1]), blue(masks[2]), alpha(masks[3]);
+
+  out_image.width = (unsigned int)width;
+  out_image.height = (unsigned int)height;
+  size_t outRowBytes = size_t(width) * out_image.channels();
+  out_image.pixels.resize(outRowBytes * height);
+
+  // File rows are padded to 4 bytes
+  size_t rowBytes = ((size_t(width) * bitsPerPixel + 31) / 32) * 4;
+  m_row.resize(rowBytes);
+
+  if (fseek(file, long(dataOffset), SEEK_SET) != 0) {
+    m_error = "has truncated pixel data";
+    return false;
+  }
+  for (long y = 0; y < height; y++) {
+    if (fread(m_row.data(), 1, rowBytes, file) != rowBytes) {
+      m_error = "has truncated pixel data";
+      return false;
+    }
+
+    long outY = isTopDown ? height - 1 - y : y;
+    unsigned char * out = out_image.pixels.data() + outY * outRowBytes;
+    const unsigned char * in = m_row.data();
+
+    if (isCopied && bitsPerPixel == 24) {
+      memcpy(out, in, outRowBytes);
+    }
+    else if (isCopied) {
+      // BGRX: drop the unused byte
+      for (long x = 0; x < width; x++, in += 4, out += 3) {
+        out[0] = in[0];
+        out[1] = in[1];
+        out[2] = in[2];
+      }
+    }
+    else if (isPalettized) {
+      unsigned int pixelsPerByte = 8 / bitsPerPixel;
+      unsigned int indexMask = (1u << bitsPerPixel) - 1;
+      for (long x = 0; x < width; x++, out += 3) {
+        unsigned int shift = 8 - bitsPerPixel * (x % pixelsPerByte + 1);
+        unsigned int index = (in[x / pixelsPerByte] >> shift) & indexMask;
+        memcpy(out, palette + 3 * index, 3);
+      }
+    }
+    else {
+      unsigned int bytesPerPixel = bitsPerPixel / 8;
+      unsigned int channels = out_image.channels();
+      for (long x = 0; x < width; x++, in += bytesPerPixel, out += channels) {
+        unsigned int pixel = bytesPerPixel == 2 ? readU16(in) :
+                             bytesPerPixel == 3 ? readU32(in) & 0xffffff :
+                                                  readU32(in);
+        out[0] = red.extract(pixel, 0);
+        out[1] = green.extract(pixel, 0);
+        out[2] = blue.extract(pixel, 0);
+        if (channels == 4) {
+          out[3] = alpha.extract(pixel, 255);
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+bool ImageDecoder::decodePNG(FILE * file, Image & out_image) {
+  if (fseek(file, 0, SEEK_END) != 0) {
+    m_error = "could not be read";
+    return false;
+  }
+  long size = ftell(file);
+  rewind(file);
+  if (size <= 0) {
+    m_error = "could not be read";
+    return false;
+  }
+  m_fileData.resize(size_t(size));
+  if (fread(m_fileData.data(), 1, m_fileData.size(), file) != m_fileData.size()) {
+    m_error = "could not be read";
+    return false;
+  }
+
+  lodepng::State state;
+  unsigned int width, height;
+  unsigned int error = lodepng_inspect( &width, &height, &state,
+                                        m_fileData.data(), m_fileData.size());
+  if (error) {
+    m_error = lodepng_error_text(error);
+    return false;
+  }
+  if (width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE) {
+    m_error = "has an invalid size";
+    return false;
+  }
+
+  bool hasAlpha = lodepng_can_have_alpha(&state.info_png.color);
+  state.info_raw.colortype = hasAlpha ? LCT_RGBA : LCT_RGB;
+  state.info_raw.bitdepth = 8;
+
+  unsigned char * decoded = NULL;
+  error = lodepng_decode( &decoded, &width, &height, &state,
+                          m_fileData.data(), m_fileData.size());
+  if (error) {
+    free(decoded);
+    m_error = lodepng_error_text(error);
+    return false;
+  }
+
+  out_image.width = width;
+  out_image.height = height;
+  out_image.format = hasAlpha ? PixelFormat::RGBA : PixelFormat::RGB;
+
+  // PNG rows are stored top row first
+  size_t rowBytes = size_t(width) * out_image.channels();
+  out_image.pixels.resize(rowBytes * height);
+  for (unsigned int y = 0; y < height; y++) {
+    memcpy( out_image.pixels.data() + (height - 1 - y) * rowBytes,
+            decoded + y * rowBytes, rowBytes);
+  }
+  free(decoded); // lodepng allocates with malloc
+
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+bool ImageDecoder::fail(const std::string & filePath, const char * reason) const {
+  cerr << "Image '" << filePath << "' " << reason << endl;
+  return false;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Channel layout of decoded pixels, 8 bits per channel
+enum class PixelFormat {
+  RGB,
+  RGBA,
+  BGR,
+  BGRA
+};
+
+// Decoded image, ready to upload: rows are tightly packed, bottom row first
+// (as GL expects texture data)
+struct Image {
+  std::string filePath;
+  std::vector<unsigned char> pixels;
+  unsigned int width;
+  unsigned int height;
+  PixelFormat format;
+
+  // Bytes per pixel of format
+  unsigned int channels() const;
+};
+
+/*
+  Decodes BMP and PNG files, telling them apart by content.
+
+  BMP: uncompressed 1, 4, 8 (palettized), 16, 24 and 32 bit images, with
+  bitfield masks, any of the info header versions, bottom-up or top-down.
+  BMPs are streamed a row at a time straight into the image; 24 and 32 bit
+  ones keep the file's BGR(A) order so they need no swizzling.
+  PNG: any format lodepng reads; decoded to RGBA if it may have alpha, else RGB.
+
+  A decoder keeps its scratch buffers between calls, and decoding into the same
+  Image reuses its pixel buffer, so loading many images doesn't keep going back
+  to the heap. A decoder is not thread safe; use one per thread.
+*/
+class ImageDecoder {
+public:
+  // Returns false, and prints why, if the file can't be decoded
+  bool decode(const std::string & filePath, Image & out_image);
+
+private:
+  bool decodeBMP(FILE * file, Image & out_image);
+  bool decodePNG(FILE * file, Image & out_image);
+  bool fail(const std::string & filePath, const char * reason) const;
+
+  std::vector<unsigned char> m_fileData; // whole PNG files
+  std::vector<unsigned char> m_row;      // one BMP row
+  std::string m_error;
+};
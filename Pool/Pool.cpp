@@ -2,10 +2,12 @@
 
 #include "Pool.hpp"
 #include "scene_lua.hpp"
-#include "TextureLoader.hpp"
 
+#include "cs488-framework/Exception.hpp"
 #include "cs488-framework/GlErrorCheck.hpp"
 #include "cs488-framework/MathUtils.hpp"
+#include "cs488-framework/Profiler.hpp"
+#include "cs488-framework/TraceRecorder.hpp"
 
 #include <imgui/imgui.h>
 
@@ -13,6 +15,10 @@
 #include <glm/gtx/io.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <cfloat>
+#include <cstddef>
+#include <sstream>
+
 using namespace glm;
 using namespace std;
 
@@ -31,9 +37,30 @@ static const float FAR_PLANE = 1000.0f;
 const size_t CIRCLE_PTS = 48;
 const float CROSSHAIR_SIZE = 0.01;
 
+// Uniform buffer binding point of the SceneUniforms block
+static const GLuint SCENE_UNIFORMS_BINDING = 0;
+
+// Shader programs, in the order the render queue is sorted by
+enum RenderProgram { BASIC_PROGRAM, TEXTURE_PROGRAM };
+
+// Range of the texture filtering settings
+static const float MIN_TEXTURE_LOD_BIAS = -1.0f;
+static const float MAX_TEXTURE_LOD_BIAS = 4.0f;
+static const int MAX_SKIPPED_MIP_LEVELS = 4;
+
+// Consolidated meshes, cached between runs
+static const char * MESH_CACHE_FILE = "meshes.cache";
+
+// Mesh drawn for every ball by the instanced path
+static const char * BALL_MESH_ID = "sphere";
+
 // Physics constants
 const float GRAVITATIONAL_ACCELERATION = 9.81f; // m / s^2
-const float UNITS_TO_METERS = 1200.0f; // convert from opengl distance to meters
+
+// Fixed-timestep simulation
+const int DEFAULT_PHYSICS_HZ = 120;
+const int MIN_PHYSICS_HZ = 30;
+const int MAX_PHYSICS_HZ = 1000;
 
 //----------------------------------------------------------------------------------------
 // Constructor
@@ -45,17 +72,37 @@ Pool::Pool(const std::string & luaSceneFile)
 	  m_texture_normalAttribLocation(0),
 	  m_texture_textureAttribLocation(0),
 	  m_vao_meshData(0),
-	  m_vbo_vertexPositions(0),
-	  m_vbo_vertexNormals(0),
+	  m_vbo_vertexData(0),
+	  m_ibo_vertexIndices(0),
+	  m_indexType(GL_UNSIGNED_SHORT),
+	  m_indexSize(sizeof(GLushort)),
+	  m_ubo_sceneUniforms(0),
+	  m_vao_ballInstances(0),
+	  m_vbo_ballInstances(0),
+	  m_ballInstanceCapacity(0),
+	  m_vao_staticData(0),
+	  m_vbo_staticVertexData(0),
+	  m_ibo_staticIndices(0),
 	  m_vao_crosshair(0),
 	  m_vbo_crosshair(0),
+	  m_isRenderQueueDirty(true),
+	  m_frameCount(0),
 	  m_zbuffer(true),
 	  m_backface_culling(false),
 	  m_frontface_culling(false),
 	  m_crosshair(true),
 	  m_texture(true),
+	  m_instancedBalls(true),
+	  m_bakeStaticGeometry(true),
+	  m_frustumCulling(true),
+	  m_showProfiler(false),
+	  m_time(0.0),
+	  m_deltaTime(0.0f),
 	  m_gravitationalAcceleration(vec3(0.0f, - GRAVITATIONAL_ACCELERATION, 0.0f)),
-	  m_strikePower(0.5f)
+	  m_strikePower(0.5f),
+	  m_physicsHz(DEFAULT_PHYSICS_HZ),
+	  m_snapshot(nullptr),
+	  m_physicsAlpha(1.0f)
 {
   m_mouseState.setCursorMode(GLFW_CURSOR_NORMAL);
 }
@@ -81,30 +128,9 @@ void Pool::init()
 	glGenVertexArrays(1, &m_vao_meshData);
 	enableVertexShaderInputSlots();
 
-	processLuaSceneFile(m_luaSceneFile);
-
-	// Load and decode all .obj files at once here.  You may add additional .obj files to
-	// this list in order to support rendering additional mesh types.  All vertex
-	// positions, and normals will be extracted and stored within the MeshConsolidator
-	// class.
-	unique_ptr<MeshConsolidator> meshConsolidator (new MeshConsolidator{
-			getAssetFilePath("cube.obj"),
-			getAssetFilePath("sphere.obj"),
-			getAssetFilePath("texturedcube.obj"),
-			getAssetFilePath("patterncube.obj"),
-			getAssetFilePath("thickpatterncube.obj"),
-			getAssetFilePath("longpatterncube.obj"),
-			getAssetFilePath("widepatterncube.obj")
-	});
-
-
-	// Acquire the BatchInfoMap from the MeshConsolidator.
-	meshConsolidator->getBatchInfoMap(m_batchInfoMap);
-
-	// Take all vertex data within the MeshConsolidator and upload it to VBOs on the GPU.
-	uploadVertexDataToVbos(*meshConsolidator);
+	loadAssets();
 
-	mapVboDataToVertexShaderInputLocations();
+	initSceneUniforms();
 
 	initPerspectiveMatrix();
 
@@ -115,17 +141,137 @@ void Pool::init()
 	initEntities();
 
 	resetAll();
+
+	// Don't count loading time as the first frame's elapsed time
+	m_time = glfwGetTime();
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * Decode the scene, meshes and textures on worker threads; their uploads run
+ * here on the GL thread as each one is ready.
+ */
+void Pool::loadAssets()
+{
+	PROFILE_SCOPE("loadAssets");
+	AssetLoader loader;
+
+	loader.load(
+		[this] { processLuaSceneFile(m_luaSceneFile); },
+		// The textures the scene names can only be decoded once it's loaded
+		[this, &loader] {
+			PROFILE_SCOPE("uploadScene");
+			preloadTextures(loader);
+		});
+
+	// Load and decode all .obj files at once here.  You may add additional .obj files to
+	// this list in order to support rendering additional mesh types.  All vertex
+	// positions, and normals will be extracted and stored within the MeshConsolidator
+	// class.  After the first run they are read from MESH_CACHE_FILE instead, until
+	// one of the .obj files changes.  The data is kept for baking static geometry.
+	loader.load(
+		[this] {
+			TRACE_SCOPE("decodeMeshes");
+			m_meshConsolidator.reset(new MeshConsolidator({
+					getAssetFilePath("cube.obj"),
+					getAssetFilePath("sphere.obj"),
+					getAssetFilePath("texturedcube.obj"),
+					getAssetFilePath("patterncube.obj"),
+					getAssetFilePath("thickpatterncube.obj"),
+					getAssetFilePath("longpatterncube.obj"),
+					getAssetFilePath("widepatterncube.obj")
+				}, getAssetFilePath(MESH_CACHE_FILE)));
+		},
+		[this] {
+			PROFILE_SCOPE("uploadMeshes");
+
+			// Acquire the BatchInfoMap from the MeshConsolidator.
+			m_meshConsolidator->getBatchInfoMap(m_batchInfoMap);
+			initMeshBounds(*m_meshConsolidator);
+
+			// Take all vertex data within the MeshConsolidator and upload it to VBOs on the GPU.
+			uploadVertexDataToVbos(*m_meshConsolidator);
+
+			mapVboDataToVertexShaderInputLocations();
+
+			initBallInstancing();
+
+			initStaticGeometry();
+		});
+
+	loader.finish([this] (size_t numLoaded, size_t numAssets) {
+		showLoadingProgress(numLoaded, numAssets);
+	});
+	// Pack the preloaded textures into arrays now that all of them are decoded
+	{
+		PROFILE_SCOPE("uploadTextures");
+		m_textureManager.uploadPreloaded();
+	}
+	glfwSetWindowTitle(m_window, m_windowTitle.c_str());
 }
 
 //----------------------------------------------------------------------------------------
 void Pool::processLuaSceneFile(const std::string & filename) {
+  TRACE_SCOPE("importLua");
   std::string assetFilePath = getAssetFilePath(filename.c_str());
   m_rootNode = std::shared_ptr<SceneNode>(import_lua(assetFilePath));
+  if (! m_rootNode) {
+    throw Exception("Unable to load scene " + assetFilePath);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * Queue every texture named by the scene on the loader, so they are decoded in
+ * parallel and already resident when initTextureIds() acquires them.
+ */
+void Pool::preloadTextures(AssetLoader & loader) {
+  set<string> filePaths;
+  collectTextureFiles(*m_rootNode, filePaths);
+
+  for (const string & filePath : filePaths) {
+    shared_ptr<Image> image(new Image());
+    loader.load(
+      [filePath, image] {
+        TRACE_SCOPE("decodeTexture");
+        if (! TextureManager::decode(filePath, *image)) {
+          // Left for initTextureIds() to report
+          image->filePath.clear();
+        }
+      },
+      [this, image] {
+        if (! image->filePath.empty()) {
+          m_textureManager.preload(std::move(*image));
+        }
+      });
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void Pool::collectTextureFiles(const SceneNode & node, set<string> & filePaths) {
+  if (node.m_nodeType == NodeType::GeometryNode) {
+    const GeometryNode & geo = static_cast<const GeometryNode &>(node);
+    for (const string & textureFile : geo.textureFiles) {
+      filePaths.insert(getAssetFilePath(textureFile.c_str()));
+    }
+  }
+
+  for (const SceneNode * child : node.children) {
+    collectTextureFiles(*child, filePaths);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void Pool::showLoadingProgress(size_t numLoaded, size_t numAssets) {
+  stringstream title;
+  title << m_windowTitle << " - Loading (" << numLoaded << "/" << numAssets << ")";
+  glfwSetWindowTitle(m_window, title.str().c_str());
 }
 
 //----------------------------------------------------------------------------------------
 void Pool::createShaderProgram()
 {
+	PROFILE_SCOPE("createShaderProgram");
 	m_shader.generateProgramObject();
 	m_shader.attachVertexShader(getAssetFilePath("VertexShader.vs").c_str());
 	m_shader.attachFragmentShader(getAssetFilePath("FragmentShader.fs").c_str());
@@ -138,6 +284,13 @@ void Pool::createShaderProgram()
 	    getAssetFilePath("TextureFragmentShader.fs").c_str());
 	m_texture_shader.link();
 	
+	m_ball_shader.generateProgramObject();
+	m_ball_shader.attachVertexShader(
+	    getAssetFilePath("InstancedBallVertexShader.vs").c_str());
+	m_ball_shader.attachFragmentShader(
+	    getAssetFilePath("InstancedBallFragmentShader.fs").c_str());
+	m_ball_shader.link();
+	
 	m_crosshair_shader.generateProgramObject();
 	m_crosshair_shader.attachVertexShader(
 	  getAssetFilePath("CrosshairVertexShader.vs").c_str());
@@ -203,43 +356,34 @@ void Pool::enableVertexShaderInputSlots()
 void Pool::uploadVertexDataToVbos (
 		const MeshConsolidator & meshConsolidator
 ) {
-	// Generate VBO to store all vertex position data
+	// Generate VBO to store all interleaved vertex data
 	{
-		glGenBuffers(1, & m_vbo_vertexPositions);
+		glGenBuffers(1, & m_vbo_vertexData);
 
-		glBindBuffer(GL_ARRAY_BUFFER, m_vbo_vertexPositions);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo_vertexData);
 
-		glBufferData(GL_ARRAY_BUFFER, meshConsolidator.getNumVertexPositionBytes(),
-				meshConsolidator.getVertexPositionDataPtr(), GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, meshConsolidator.getNumVertexBytes(),
+				meshConsolidator.getVertexDataPtr(), GL_STATIC_DRAW);
 
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		CHECK_GL_ERRORS;
 	}
 
-	// Generate VBO to store all vertex normal data
+	// Generate IBO to store the triangles' vertex indices.  It is attached to the
+	// VAOs that draw meshes in mapVboDataToVertexShaderInputLocations().
 	{
-		glGenBuffers(1, & m_vbo_vertexNormals);
+		glGenBuffers(1, & m_ibo_vertexIndices);
 
-		glBindBuffer(GL_ARRAY_BUFFER, m_vbo_vertexNormals);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo_vertexIndices);
 
-		glBufferData(GL_ARRAY_BUFFER, meshConsolidator.getNumVertexNormalBytes(),
-				meshConsolidator.getVertexNormalDataPtr(), GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshConsolidator.getNumIndexBytes(),
+				meshConsolidator.getIndexDataPtr(), GL_STATIC_DRAW);
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 		CHECK_GL_ERRORS;
-	}
-	
-	// Generate VBO to store all vertex texture UV data
-	{
-	  glGenBuffers(1, & m_vbo_vertexTextureUVs);
-
-		glBindBuffer(GL_ARRAY_BUFFER, m_vbo_vertexTextureUVs);
-
-		glBufferData(GL_ARRAY_BUFFER, meshConsolidator.getNumVertexTextureBytes(),
-				meshConsolidator.getVertexTextureDataPtr(), GL_STATIC_DRAW);
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		CHECK_GL_ERRORS;
+		m_indexSize = meshConsolidator.getIndexSize();
+		m_indexType = m_indexSize == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 	}
 
 	// Generate VBO to store the crosshair.
@@ -267,22 +411,22 @@ void Pool::mapVboDataToVertexShaderInputLocations()
 	// Bind VAO in order to record the data mapping.
 	glBindVertexArray(m_vao_meshData);
 
-	// Tell GL how to map data from the vertex buffer "m_vbo_vertexPositions" into the
-	// "position" vertex attribute location for any bound vertex shader program.
-	glBindBuffer(GL_ARRAY_BUFFER, m_vbo_vertexPositions);
-	glVertexAttribPointer(m_positionAttribLocation, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-	glVertexAttribPointer(m_texture_positionAttribLocation, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-	// Tell GL how to map data from the vertex buffer "m_vbo_vertexNormals" into the
-	// "normal" vertex attribute location for any bound vertex shader program.
-	glBindBuffer(GL_ARRAY_BUFFER, m_vbo_vertexNormals);
-	glVertexAttribPointer(m_normalAttribLocation, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-	glVertexAttribPointer(m_texture_normalAttribLocation, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-  // Tell GL how to map data from the vertex buffer "m_vbo_vertexTextureUVs" into the
-	// "textureUV" vertex attribute location for any bound vertex shader program.
-	glBindBuffer(GL_ARRAY_BUFFER, m_vbo_vertexTextureUVs);
-	glVertexAttribPointer(m_texture_textureAttribLocation, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+	// Tell GL how to map data from the interleaved vertex buffer "m_vbo_vertexData"
+	// into the "position", "normal" and "textureUV" vertex attribute locations for
+	// any bound vertex shader program.
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo_vertexData);
+	GLsizei stride = sizeof(Vertex);
+	const void * positionOffset = reinterpret_cast<void *>(offsetof(Vertex, position));
+	const void * normalOffset = reinterpret_cast<void *>(offsetof(Vertex, normal));
+	const void * uvOffset = reinterpret_cast<void *>(offsetof(Vertex, uv));
+	glVertexAttribPointer(m_positionAttribLocation, 3, GL_FLOAT, GL_FALSE, stride, positionOffset);
+	glVertexAttribPointer(m_texture_positionAttribLocation, 3, GL_FLOAT, GL_FALSE, stride, positionOffset);
+	glVertexAttribPointer(m_normalAttribLocation, 3, GL_FLOAT, GL_FALSE, stride, normalOffset);
+	glVertexAttribPointer(m_texture_normalAttribLocation, 3, GL_FLOAT, GL_FALSE, stride, normalOffset);
+	glVertexAttribPointer(m_texture_textureAttribLocation, 2, GL_FLOAT, GL_FALSE, stride, uvOffset);
+
+	// The element array binding is part of the VAO's state.
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo_vertexIndices);
 
   // Bind VAO in order to record the data mapping.
 	glBindVertexArray(m_vao_crosshair);
@@ -299,6 +443,126 @@ void Pool::mapVboDataToVertexShaderInputLocations()
 	CHECK_GL_ERRORS;
 }
 
+//----------------------------------------------------------------------------------------
+/*
+ * The instanced ball VAO reads position, normal and indices from the shared
+ * mesh buffers, and everything else from m_vbo_ballInstances, advancing once
+ * per instance.
+ */
+void Pool::initBallInstancing()
+{
+	glGenVertexArrays(1, &m_vao_ballInstances);
+	glGenBuffers(1, &m_vbo_ballInstances);
+
+	glBindVertexArray(m_vao_ballInstances);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo_vertexData);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo_vertexIndices);
+	GLsizei stride = sizeof(Vertex);
+
+	GLint location = m_ball_shader.getAttribLocation("position");
+	glEnableVertexAttribArray(location);
+	glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride,
+	                      reinterpret_cast<void *>(offsetof(Vertex, position)));
+
+	location = m_ball_shader.getAttribLocation("normal");
+	glEnableVertexAttribArray(location);
+	glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride,
+	                      reinterpret_cast<void *>(offsetof(Vertex, normal)));
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo_ballInstances);
+	stride = sizeof(BallInstance);
+
+	// A mat4 attribute takes up four consecutive locations, one per column
+	location = m_ball_shader.getAttribLocation("model");
+	for (GLint column = 0; column < 4; column++) {
+		size_t offset = offsetof(BallInstance, model) + column * sizeof(vec4);
+		glEnableVertexAttribArray(location + column);
+		glVertexAttribPointer(location + column, 4, GL_FLOAT, GL_FALSE, stride,
+		                      reinterpret_cast<void *>(offset));
+		glVertexAttribDivisor(location + column, 1);
+	}
+
+	location = m_ball_shader.getAttribLocation("kd");
+	glEnableVertexAttribArray(location);
+	glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride,
+	                      reinterpret_cast<void *>(offsetof(BallInstance, kd)));
+	glVertexAttribDivisor(location, 1);
+
+	location = m_ball_shader.getAttribLocation("ks");
+	glEnableVertexAttribArray(location);
+	glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride,
+	                      reinterpret_cast<void *>(offsetof(BallInstance, ks)));
+	glVertexAttribDivisor(location, 1);
+
+	location = m_ball_shader.getAttribLocation("shininess");
+	glEnableVertexAttribArray(location);
+	glVertexAttribPointer(location, 1, GL_FLOAT, GL_FALSE, stride,
+	                      reinterpret_cast<void *>(offsetof(BallInstance, shininess)));
+	glVertexAttribDivisor(location, 1);
+
+	//-- Unbind target, and restore default values:
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	CHECK_GL_ERRORS;
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * The baked buffers are filled in by uploadStaticGeometry() whenever the
+ * render queue is rebuilt; the VAO maps them like m_vao_meshData.
+ */
+void Pool::initStaticGeometry()
+{
+	glGenVertexArrays(1, &m_vao_staticData);
+	glGenBuffers(1, &m_vbo_staticVertexData);
+	glGenBuffers(1, &m_ibo_staticIndices);
+
+	glBindVertexArray(m_vao_staticData);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo_staticVertexData);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo_staticIndices);
+	GLsizei stride = sizeof(Vertex);
+	const void * positionOffset = reinterpret_cast<void *>(offsetof(Vertex, position));
+	const void * normalOffset = reinterpret_cast<void *>(offsetof(Vertex, normal));
+	const void * uvOffset = reinterpret_cast<void *>(offsetof(Vertex, uv));
+
+	const GLint positionLocations[] =
+			{ m_positionAttribLocation, m_texture_positionAttribLocation };
+	for (GLint location : positionLocations) {
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, positionOffset);
+	}
+	const GLint normalLocations[] =
+			{ m_normalAttribLocation, m_texture_normalAttribLocation };
+	for (GLint location : normalLocations) {
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, normalOffset);
+	}
+	glEnableVertexAttribArray(m_texture_textureAttribLocation);
+	glVertexAttribPointer( m_texture_textureAttribLocation, 2, GL_FLOAT, GL_FALSE,
+	                       stride, uvOffset);
+
+	//-- Unbind target, and restore default values:
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	CHECK_GL_ERRORS;
+}
+
+//----------------------------------------------------------------------------------------
+void Pool::initMeshBounds(const MeshConsolidator & meshConsolidator) {
+  const Vertex * vertices = meshConsolidator.getVertexDataPtr();
+  for (const auto & batch : m_batchInfoMap) {
+    BoundingBox & bounds = m_meshBounds[batch.first];
+    size_t end = batch.second.startIndex + batch.second.numIndices;
+    for (size_t i = batch.second.startIndex; i < end; i++) {
+      bounds.expand(vertices[meshConsolidator.getIndex(i)].position);
+    }
+  }
+}
+
 //----------------------------------------------------------------------------------------
 void Pool::initPerspectiveMatrix()
 {
@@ -319,6 +583,7 @@ void Pool::initLightSources() {
 
 //----------------------------------------------------------------------------------------
 void Pool::initTextureIds() {
+  PROFILE_SCOPE("initTextureIds");
   initTextureIdsHelper(*m_rootNode);  
 }
 
@@ -329,9 +594,8 @@ void Pool::initTextureIdsHelper(SceneNode & node) {
     for ( auto it = geo->textureFiles.begin();
           it != geo->textureFiles.end(); it++)
     {
-      const char * texturePath = getAssetFilePath(it->c_str()).c_str();
-      GLuint textureId = loadBMP_custom( texturePath, geo->textureData,
-                                         geo->textureWidth, geo->textureHeight);
+      GLuint textureId =
+          m_textureManager.acquire(getAssetFilePath(it->c_str()));
       if (textureId == 0) {
         cerr << "Failed to load texture '" << *it << "' for Geometry Node "
              << geo->m_name << endl;
@@ -346,8 +610,26 @@ void Pool::initTextureIdsHelper(SceneNode & node) {
 	}
 }
 
+//----------------------------------------------------------------------------------------
+void Pool::releaseTextureIdsHelper(SceneNode & node) {
+  if (node.m_nodeType == NodeType::GeometryNode) {
+    GeometryNode * geo = static_cast<GeometryNode *>(& node);
+    for (GLuint textureId : geo->textureIds) {
+      m_textureManager.release(textureId);
+    }
+    geo->textureIds.clear();
+  }
+
+  for (SceneNode * child : node.children) {
+    releaseTextureIdsHelper(*child);
+  }
+}
+
 //----------------------------------------------------------------------------------------
 void Pool::initEntities() {
+  PROFILE_SCOPE("initEntities");
+
+  Table table;
   for ( const SceneNode * child : m_rootNode->children) {  
     if ( child->m_name == "poolsurface" ||
          ( child->m_name.size() >= 8 &&
@@ -357,77 +639,79 @@ void Pool::initEntities() {
       vec3 extents = vec3(child->scaleTrans * vec4(1.0f, 1.0f, 1.0f, 0.0f));
       Box box(child->m_name, center, extents);
       if (child->m_name == "poolsurface") {
-        m_poolsurface = box;
+        table.setSurface(box);
       }
       else {
-        m_edges.push_back(box);
+        table.addCushion(box);
       }
     }
     else if (child->m_name.substr(child->m_name.size() - 4, 4) == "Ball") {
       vec3 center = vec3(child->trans * vec4(0.0f, 0.0f, 0.0f, 1.0f));
-      m_balls.push_back(Ball(child->m_name, center, 1.0f));
-      m_geoToBall[child->m_nodeId] = m_balls.size() - 1;
+      m_geoToBall[child->m_nodeId] =
+          table.addBall(Ball(child->m_name, center, 1.0f));
     }
   }
+
+  m_simulation.start(table, m_physicsHz);
+  m_snapshot = & m_simulation.getSnapshot();
 }
 
 //----------------------------------------------------------------------------------------
-void Pool::uploadCommonSceneUniforms() {
-	m_shader.enable();
-	{
-		//-- Set Perpsective matrix uniform for the scene:
-		GLint location = m_shader.getUniformLocation("Perspective");
-		glUniformMatrix4fv(location, 1, GL_FALSE, value_ptr(m_projectionMat));
-		CHECK_GL_ERRORS;
-
-		//-- Set LightSource uniform for the scene:
-		{
-			location = m_shader.getUniformLocation("light.position");
-			glUniform3fv(location, 1, value_ptr(m_light.position));
-			location = m_shader.getUniformLocation("light.rgbIntensity");
-			glUniform3fv(location, 1, value_ptr(m_light.rgbIntensity));
-			CHECK_GL_ERRORS;
-		}
-
-    #ifdef DEBUGOUT
-      //cerr << "uploading ambient intensity uniform for basic shader" << endl;
-    #endif
-
-		//-- Set background light ambient intensity
-		{
-			location = m_shader.getUniformLocation("ambientIntensity");
-			vec3 ambientIntensity(0.05f);
-			glUniform3fv(location, 1, value_ptr(ambientIntensity));
-			CHECK_GL_ERRORS;
-		}
-	}
-	m_shader.disable();	
+/*
+ * Every program reads projection, view and lighting from one uniform buffer,
+ * and looks up the locations of its per-mesh uniforms once, here.
+ */
+void Pool::initSceneUniforms()
+{
+	glGenBuffers(1, &m_ubo_sceneUniforms);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_ubo_sceneUniforms);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(SceneUniforms), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, SCENE_UNIFORMS_BINDING, m_ubo_sceneUniforms);
+	CHECK_GL_ERRORS;
 
+	m_shader.bindUniformBlock("SceneUniforms", SCENE_UNIFORMS_BINDING);
+	m_texture_shader.bindUniformBlock("SceneUniforms", SCENE_UNIFORMS_BINDING);
+	m_ball_shader.bindUniformBlock("SceneUniforms", SCENE_UNIFORMS_BINDING);
+
+	m_shaderUniforms.modelView = m_shader.getUniformLocation("ModelView");
+	m_shaderUniforms.normalMatrix = m_shader.getUniformLocation("NormalMatrix");
+	m_shaderUniforms.kd = m_shader.getUniformLocation("material.kd");
+	m_shaderUniforms.ks = m_shader.getUniformLocation("material.ks");
+	m_shaderUniforms.shininess = m_shader.getUniformLocation("material.shininess");
+	m_shaderUniforms.textureLayer = -1;
+
+	// The texture takes the place of kd
+	m_texture_shaderUniforms.modelView = m_texture_shader.getUniformLocation("ModelView");
+	m_texture_shaderUniforms.normalMatrix =
+	    m_texture_shader.getUniformLocation("NormalMatrix");
+	m_texture_shaderUniforms.kd = -1;
+	m_texture_shaderUniforms.ks = m_texture_shader.getUniformLocation("material.ks");
+	m_texture_shaderUniforms.shininess =
+	    m_texture_shader.getUniformLocation("material.shininess");
+	m_texture_shaderUniforms.textureLayer =
+	    m_texture_shader.getUniformLocation("textureLayer");
+
+	// Textures are always bound to unit 0
 	m_texture_shader.enable();
-	{
-		//-- Set Perpsective matrix uniform for the scene:
-		GLint location = m_texture_shader.getUniformLocation("Perspective");
-		glUniformMatrix4fv(location, 1, GL_FALSE, value_ptr(m_projectionMat));
-		CHECK_GL_ERRORS;
-
-		//-- Set LightSource uniform for the scene:
-		{
-			location = m_texture_shader.getUniformLocation("light.position");
-			glUniform3fv(location, 1, value_ptr(m_light.position));
-			location = m_texture_shader.getUniformLocation("light.rgbIntensity");
-			glUniform3fv(location, 1, value_ptr(m_light.rgbIntensity));
-			CHECK_GL_ERRORS;
-		}
-  
-		//-- Set background light ambient intensity
-		{
-			location = m_texture_shader.getUniformLocation("ambientIntensity");
-			vec3 ambientIntensity(0.05f);
-			glUniform3fv(location, 1, value_ptr(ambientIntensity));
-			CHECK_GL_ERRORS;
-		}
-	}
+	glUniform1i(m_texture_shader.getUniformLocation("textureSampler"), 0);
 	m_texture_shader.disable();
+	CHECK_GL_ERRORS;
+}
+
+//----------------------------------------------------------------------------------------
+void Pool::uploadCommonSceneUniforms() {
+	SceneUniforms uniforms;
+	uniforms.perspective = m_projectionMat;
+	uniforms.view = m_camera.getViewMat();
+	uniforms.lightPosition = vec4(m_light.position, 1.0f);
+	uniforms.lightRgbIntensity = vec4(m_light.rgbIntensity, 0.0f);
+	uniforms.ambientIntensity = vec4(vec3(0.05f), 0.0f);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_ubo_sceneUniforms);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(SceneUniforms), &uniforms);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	CHECK_GL_ERRORS;
 }
 
 //----------------------------------------------------------------------------------------
@@ -437,8 +721,6 @@ void Pool::uploadCommonSceneUniforms() {
 void Pool::appLogic()
 {
 	// Place per frame, application logic here ...
-	uploadCommonSceneUniforms();
-
 	updateTime();
 
   // reset mouse to the initial locked position
@@ -485,9 +767,16 @@ void Pool::guiLogic()
     }
     
     ImGui::SliderFloat("Power", &m_strikePower, 0.0f, 1.0f);
+    if (ImGui::SliderInt("Physics Hz", &m_physicsHz, MIN_PHYSICS_HZ, MAX_PHYSICS_HZ)) {
+      m_simulation.setStepsPerSecond(m_physicsHz);
+    }
 
 		ImGui::Text( "Framerate: %.1f FPS", ImGui::GetIO().Framerate );
 	ImGui::End();
+
+	if (m_showProfiler) {
+		showProfilerWindow();
+	}
 }
 
 //----------------------------------------------------------------------------------------
@@ -496,58 +785,168 @@ void Pool::showOptionsMenu() {
   if (ImGui::MenuItem("Z-Buffer", NULL, &m_zbuffer));
   if (ImGui::MenuItem("Backface Culling", NULL, &m_backface_culling));
   if (ImGui::MenuItem("Frontface Culling", NULL, &m_frontface_culling));
-  if (ImGui::MenuItem("Texture Mapping", "T", &m_texture));
+  // These change which program, or which buffers, draw some nodes
+  if (ImGui::MenuItem("Texture Mapping", "T", &m_texture)) {
+    m_isRenderQueueDirty = true;
+  }
+  if (ImGui::MenuItem("Instanced Balls", NULL, &m_instancedBalls)) {
+    m_isRenderQueueDirty = true;
+  }
+  if (ImGui::MenuItem("Bake Static Geometry", NULL, &m_bakeStaticGeometry)) {
+    m_isRenderQueueDirty = true;
+  }
+  ImGui::MenuItem("Frustum Culling", NULL, &m_frustumCulling);
+  ImGui::MenuItem("Profiler", "F3", &m_showProfiler);
+  if (ImGui::BeginMenu("Texture Filtering")) {
+    showTextureFilteringMenu();
+    ImGui::EndMenu();
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void Pool::showTextureFilteringMenu() {
+  TextureManager::Filtering filtering = m_textureManager.getFiltering();
+  bool isChanged = false;
+
+  const char * modeNames[] = { "Nearest", "Bilinear", "Trilinear" };
+  for (int mode = 0; mode < 3; mode++) {
+    if (ImGui::MenuItem(modeNames[mode], NULL, filtering.mode == mode)) {
+      filtering.mode = TextureManager::Filtering::Mode(mode);
+      isChanged = true;
+    }
+  }
+
+  ImGui::Separator();
+  float maxAnisotropy = m_textureManager.getMaxAnisotropy();
+  if (ImGui::BeginMenu("Anisotropy", maxAnisotropy > 1.0f)) {
+    for (float anisotropy = 1.0f; anisotropy <= maxAnisotropy; anisotropy *= 2.0f) {
+      stringstream label;
+      label << anisotropy << "x";
+      if (ImGui::MenuItem(label.str().c_str(), NULL, filtering.anisotropy == anisotropy)) {
+        filtering.anisotropy = anisotropy;
+        isChanged = true;
+      }
+    }
+    ImGui::EndMenu();
+  }
+
+  // For slow machines: sample coarser mip levels
+  isChanged |= ImGui::SliderFloat("LOD Bias", &filtering.lodBias,
+                                  MIN_TEXTURE_LOD_BIAS, MAX_TEXTURE_LOD_BIAS);
+  isChanged |= ImGui::SliderInt("Skip Mip Levels", &filtering.skippedLevels,
+                                0, MAX_SKIPPED_MIP_LEVELS);
+
+  if (isChanged) {
+    m_textureManager.setFiltering(filtering);
+  }
 }
 
 //----------------------------------------------------------------------------------------
-// Update mesh specific shader uniforms:
-static void updateShaderUniforms(
-		const ShaderProgram & shader,
+// Update mesh specific shader uniforms of the enabled program:
+static void uploadMeshUniforms(
+		const MeshUniformLocations & locations,
 		const GeometryNode & node,
 		const glm::mat4 & viewMatrix,
 		const glm::mat4 & modelMatrix,
 		bool isTextured
 ) {
-	shader.enable();
-	{
-		//-- Set ModelView matrix:
-		GLint location = shader.getUniformLocation("ModelView");
-		mat4 modelView = viewMatrix * modelMatrix * node.trans;
-		glUniformMatrix4fv(location, 1, GL_FALSE, value_ptr(modelView));
+	//-- Set ModelView matrix:
+	mat4 modelView = viewMatrix * modelMatrix;
+	glUniformMatrix4fv(locations.modelView, 1, GL_FALSE, value_ptr(modelView));
+	CHECK_GL_ERRORS;
+
+	//-- Set NormMatrix:
+	mat3 normalMatrix = glm::transpose(glm::inverse(mat3(modelView)));
+	glUniformMatrix3fv(locations.normalMatrix, 1, GL_FALSE, value_ptr(normalMatrix));
+	CHECK_GL_ERRORS;
+
+	if (! isTextured && locations.kd != -1) {
+		//-- Set Material values:
+		glUniform3fv(locations.kd, 1, value_ptr(node.material.kd));
 		CHECK_GL_ERRORS;
+	}
 
-	  //-- Set NormMatrix:
-	  location = shader.getUniformLocation("NormalMatrix");
-	  mat3 normalMatrix = glm::transpose(glm::inverse(mat3(modelView)));
-	  glUniformMatrix3fv(location, 1, GL_FALSE, value_ptr(normalMatrix));
-	  CHECK_GL_ERRORS;
-
-    if (! isTextured) {
-	    //-- Set Material values:
-      location = shader.getUniformLocation("material.kd");
-      vec3 kd = node.material.kd;
-      glUniform3fv(location, 1, value_ptr(kd));
-      CHECK_GL_ERRORS;
+	glUniform3fv(locations.ks, 1, value_ptr(node.material.ks));
+	CHECK_GL_ERRORS;
+
+	glUniform1f(locations.shininess, node.material.shininess);
+	CHECK_GL_ERRORS;
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * Frame times over the profiler's history, with their percentiles, and the
+ * time each scope took per frame; startup scopes are listed once. The full
+ * timeline, worker threads included, can be saved as a Chrome trace.
+ */
+void Pool::showProfilerWindow() {
+  const Profiler & profiler = Profiler::get();
+
+  ImGui::Begin( "Profiler", &m_showProfiler, ImVec2(380, 480), 0.75f,
+                ImGuiWindowFlags_AlwaysAutoResize);
+
+  // Oldest first, as the graphs want them
+  size_t numFrames, latest;
+  const float * frameTimes = profiler.getFrameTimes(numFrames, latest);
+  vector<float> cpuPlot(numFrames), gpuPlot(numFrames, 0.0f);
+  for (size_t i = 0; i < numFrames; i++) {
+    size_t frame = (latest + Profiler::HISTORY_SIZE - (numFrames - 1 - i)) %
+                   Profiler::HISTORY_SIZE;
+    cpuPlot[i] = frameTimes[frame];
+    for (const Profiler::Scope & scope : profiler.getScopes()) {
+      if (scope.isGpu) {
+        gpuPlot[i] += scope.history[frame];
+      }
     }
-    
-    location = shader.getUniformLocation("material.ks");
-    vec3 ks = node.material.ks;
-    glUniform3fv(location, 1, value_ptr(ks));
-    CHECK_GL_ERRORS;
-    
-    location = shader.getUniformLocation("material.shininess");
-    glUniform1f(location, node.material.shininess);
-    CHECK_GL_ERRORS;
+  }
 
-    if (isTextured) {
-      //-- Set Textures
-      location = shader.getUniformLocation("textureSampler");
-      CHECK_GL_ERRORS;
-      glUniform1i(location, 0);
-      CHECK_GL_ERRORS;
+  if (numFrames > 0) {
+    ImGui::PlotLines( "Frame", cpuPlot.data(), int(numFrames), 0, "ms", 0.0f,
+                      FLT_MAX, ImVec2(280, 60));
+    ImGui::PlotLines( "GPU", gpuPlot.data(), int(numFrames), 0, "ms", 0.0f,
+                      FLT_MAX, ImVec2(280, 60));
+  }
+  ImGui::Text( "Frame ms  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f",
+               profiler.getFrameTimePercentile(0.5f),
+               profiler.getFrameTimePercentile(0.95f),
+               profiler.getFrameTimePercentile(0.99f),
+               profiler.getFrameTimePercentile(1.0f));
+
+  // Per-scope breakdown: average and worst ms per frame
+  for (int gpu = 0; gpu < 2; gpu++) {
+    ImGui::Separator();
+    ImGui::Columns(3, gpu ? "gpuScopes" : "cpuScopes");
+    ImGui::Text(gpu ? "GPU" : "CPU"); ImGui::NextColumn();
+    ImGui::Text("avg ms"); ImGui::NextColumn();
+    ImGui::Text("max ms"); ImGui::NextColumn();
+    for (const Profiler::Scope & scope : profiler.getScopes()) {
+      if (scope.isGpu != bool(gpu) || (scope.isStartup && ! scope.isGpu)) {
+        continue;
+      }
+      float averageMs, maxMs;
+      profiler.getScopeStats(scope, averageMs, maxMs);
+      ImGui::Text("%*s%s", 2 * scope.depth, "", scope.name.c_str());
+      ImGui::NextColumn();
+      ImGui::Text("%.3f", averageMs); ImGui::NextColumn();
+      ImGui::Text("%.3f", maxMs); ImGui::NextColumn();
     }
-	}
-	shader.disable();
+    ImGui::Columns(1);
+  }
+
+  if (ImGui::Button("Save Trace (F12)")) {
+    dumpTrace();
+  }
+
+  if (ImGui::CollapsingHeader("Startup")) {
+    for (const Profiler::Scope & scope : profiler.getScopes()) {
+      if (scope.isStartup) {
+        ImGui::Text( "%*s%-24s %8.2f ms", 2 * scope.depth, "", scope.name.c_str(),
+                     scope.startupMs);
+      }
+    }
+  }
+
+  ImGui::End();
 }
 
 //----------------------------------------------------------------------------------------
@@ -555,6 +954,9 @@ static void updateShaderUniforms(
  * Called once per frame, after guiLogic().
  */
 void Pool::draw() {
+  // After appLogic(), so the camera has already moved this frame
+  uploadCommonSceneUniforms();
+
   if (m_zbuffer) {
 	  glEnable( GL_DEPTH_TEST );
 	}
@@ -572,6 +974,7 @@ void Pool::draw() {
 
 //----------------------------------------------------------------------------------------
 void Pool::renderSceneGraph(const SceneNode & root) {
+  PROFILE_SCOPE("renderSceneGraph");
 
   if (m_backface_culling && m_frontface_culling) {
     glEnable(GL_CULL_FACE);
@@ -589,92 +992,313 @@ void Pool::renderSceneGraph(const SceneNode & root) {
     glDisable(GL_CULL_FACE);
   }
 
+  if (m_isRenderQueueDirty) {
+    buildRenderQueue(root);
+  }
+
+  // A default Frustum accepts everything
+  m_frameCount++;
+  m_frustum = m_frustumCulling ?
+              Frustum(m_projectionMat * m_camera.getViewMat()) : Frustum();
+  {
+    PROFILE_SCOPE("cullSceneGraph");
+    cullSceneGraph(root, false);
+  }
+
+	if (! m_staticGeometry.getQueue().getItems().empty()) {
+		PROFILE_GPU_SCOPE("Static geometry");
+		glBindVertexArray(m_vao_staticData);
+		renderRenderQueue(m_staticGeometry.getQueue(), true);
+	}
+
 	// Bind the VAO once here, and reuse for all GeometryNode rendering below.
 	glBindVertexArray(m_vao_meshData);
 
-  stack<mat4> matStack;
-  matStack.push(mat4());
-
-  renderSceneNode(root, matStack);
+  {
+    PROFILE_GPU_SCOPE("Scene");
+    renderRenderQueue(m_renderQueue, false);
+  }
 
 	glBindVertexArray(0);
 	CHECK_GL_ERRORS;
+
+  renderBallInstances();
 }
 
 //----------------------------------------------------------------------------------------
-void Pool::renderSceneNode(const SceneNode & node, stack<mat4> & matStack) {
-  mat4 dynamicTrans;
-  matStack.push(matStack.top() * node.trans * dynamicTrans);
+void Pool::buildRenderQueue(const SceneNode & root) {
+  PROFILE_SCOPE("buildRenderQueue");
+  m_renderQueue.clear();
+  m_ballInstanceQueue.clear();
+  m_staticQueue.clear();
+
+  // Nothing but the balls moves, so the bounds only change along with the
+  // render queue
+  updateBounds(root);
+  buildRenderQueueHelper(root);
+
+  m_renderQueue.sort();
+  m_staticGeometry.bake(m_staticQueue.getItems(), *m_meshConsolidator);
+  uploadStaticGeometry();
+  m_isRenderQueueDirty = false;
+}
 
+//----------------------------------------------------------------------------------------
+void Pool::buildRenderQueueHelper(const SceneNode & node) {
   for (const SceneNode * child : node.children) {
-    switch(child->m_nodeType) {
-      case NodeType::GeometryNode: {
-        const GeometryNode * geometryNode =
-            static_cast<const GeometryNode *>(child);
-        mat4 ballTransform;
-        if (m_geoToBall.find(geometryNode->m_nodeId) != m_geoToBall.end()) {
-          ballTransform = m_balls.at(m_geoToBall[geometryNode->m_nodeId]).trans;
-        }
-        renderGeometryNode(*geometryNode, matStack.top() * ballTransform);
-        break;
+    if (child->m_nodeType == NodeType::GeometryNode) {
+      const GeometryNode * geometryNode = static_cast<const GeometryNode *>(child);
+      bool isTextured = geometryNode->isTextured() && m_texture;
+
+      RenderItem item;
+      item.node = geometryNode;
+      item.program = isTextured ? TEXTURE_PROGRAM : BASIC_PROGRAM;
+      // Textures were uploaded once by the TextureManager, as layers of a
+      // shared array texture; just bind the array and pick the layer
+      GLuint texture = isTextured ? geometryNode->textureIds.back() : 0;
+      item.texture = m_textureManager.getArray(texture);
+      item.textureLayer = m_textureManager.getLayer(texture);
+      item.batch = m_batchInfoMap[geometryNode->meshId];
+      auto ball = m_geoToBall.find(geometryNode->m_nodeId);
+      item.ball = ball != m_geoToBall.end() ? ball->second : -1;
+      item.bounds = m_meshBounds[geometryNode->meshId];
+
+      if (item.ball != -1 && isInstancedBall(*geometryNode)) {
+        m_ballInstanceQueue.push(item);
+      }
+      else if (item.ball == -1 && m_bakeStaticGeometry) {
+        m_staticQueue.push(item);
+      }
+      else {
+        m_renderQueue.push(item);
       }
     }
 
-    renderSceneNode(*child, matStack);
-	}
-	matStack.pop();
+    buildRenderQueueHelper(*child);
+  }
 }
 
 //----------------------------------------------------------------------------------------
-void Pool::renderGeometryNode(const GeometryNode & node, mat4 modelMat) {
-  bool isTextured = node.isTextured() && m_texture;
-  if (isTextured) {      
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, node.textureIds.back());
-    CHECK_GL_ERRORS;
+/*
+ * Balls are left out: their transforms come from the table rather than the
+ * scene graph, so they are bounded and culled one by one as they're drawn.
+ */
+void Pool::updateBounds(const SceneNode & node) {
+  node.bounds = BoundingBox();
+  if (node.m_nodeType == NodeType::GeometryNode) {
+    const GeometryNode & geo = static_cast<const GeometryNode &>(node);
+    geo.meshBounds = BoundingBox();
+    if (m_geoToBall.find(geo.m_nodeId) == m_geoToBall.end()) {
+      geo.meshBounds = m_meshBounds[geo.meshId].transformed(geo.get_world_transform());
+    }
+    node.bounds.expand(geo.meshBounds);
+  }
 
-    // Give the image to OpenGL
-    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGB, node.textureWidth,
-                  node.textureHeight, 0, GL_BGR, GL_UNSIGNED_BYTE,
-                  node.textureData);
-    CHECK_GL_ERRORS;
+  for (const SceneNode * child : node.children) {
+    updateBounds(*child);
+    node.bounds.expand(child->bounds);
+  }
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    CHECK_GL_ERRORS;
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    CHECK_GL_ERRORS;
-  
-    updateShaderUniforms( m_texture_shader, node, m_camera.getViewMat(),
-                          modelMat, isTextured);
+//----------------------------------------------------------------------------------------
+/*
+ * Marks the visible nodes with this frame's number. Subtrees entirely outside
+ * the frustum are skipped, and ones entirely inside it aren't tested further.
+ */
+void Pool::cullSceneGraph(const SceneNode & node, bool isInside) {
+  if (! isInside) {
+    Frustum::Containment containment = m_frustum.classify(node.bounds);
+    if (containment == Frustum::OUTSIDE) {
+      return;
+    }
+    isInside = containment == Frustum::INSIDE;
   }
-  else {
-    updateShaderUniforms( m_shader, node, m_camera.getViewMat(), modelMat,
-                          isTextured);
+
+  // The subtree is in view, but a GeometryNode's own mesh may not be
+  if ( isInside || node.m_nodeType != NodeType::GeometryNode ||
+       m_frustum.intersects(static_cast<const GeometryNode &>(node).meshBounds) )
+  {
+    node.lastVisibleFrame = m_frameCount;
   }
 
-	// Get the BatchInfo corresponding to the GeometryNode's unique MeshId.
-	BatchInfo batchInfo = m_batchInfoMap[node.meshId];
+  for (const SceneNode * child : node.children) {
+    cullSceneGraph(*child, isInside);
+  }
+}
 
-	//-- Now render the mesh:
-	if (node.isTextured() && m_texture) {
-	  m_texture_shader.enable();
-	}
-	else {
-	  m_shader.enable();
-	}
-	
-	glDrawArrays(GL_TRIANGLES, batchInfo.startIndex, batchInfo.numIndices);
-	if (isTextured) {
-	  m_texture_shader.disable();
-	  glBindTexture(GL_TEXTURE_2D, 0);
-	}
-	else {
-	  m_shader.disable();
-	}
+//----------------------------------------------------------------------------------------
+/*
+ * Items are sorted by program and texture, so each is only switched when it
+ * actually changes. Textures of the same size share an array texture, so
+ * moving to another of them only changes the layer uniform.
+ * Baked items are already in world space and index m_ibo_staticIndices; the
+ * others index m_ibo_vertexIndices.
+ * Items outside the view frustum are skipped: baked batches and balls by their
+ * own bounds, other nodes as marked by cullSceneGraph().
+ */
+void Pool::renderRenderQueue(const RenderQueue & queue, bool isBaked) {
+  mat4 viewMatrix = m_camera.getViewMat();
+  GLenum indexType = isBaked ? GL_UNSIGNED_INT : m_indexType;
+  size_t indexSize = isBaked ? sizeof(GLuint) : m_indexSize;
+  const ShaderProgram * program = nullptr;
+  const MeshUniformLocations * locations = nullptr;
+  GLuint texture = 0;
+
+  glActiveTexture(GL_TEXTURE0);
+  for (const RenderItem & item : queue.getItems()) {
+    // Only balls move; everything else reuses its cached world transform
+    mat4 modelMatrix;
+    if (item.ball != -1) {
+      modelMatrix = ballModelMatrix(item);
+      if (! m_frustum.intersects(item.bounds.transformed(modelMatrix))) {
+        continue;
+      }
+    }
+    else if (isBaked) {
+      if (! m_frustum.intersects(item.bounds)) {
+        continue;
+      }
+    }
+    else {
+      if (item.node->lastVisibleFrame != m_frameCount) {
+        continue;
+      }
+      modelMatrix = item.node->get_world_transform();
+    }
+
+    const ShaderProgram * itemProgram =
+        item.program == TEXTURE_PROGRAM ? & m_texture_shader : & m_shader;
+    if (itemProgram != program) {
+      program = itemProgram;
+      locations = item.program == TEXTURE_PROGRAM ?
+                  & m_texture_shaderUniforms : & m_shaderUniforms;
+      program->enable();
+    }
+    if (item.texture != texture) {
+      texture = item.texture;
+      glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+      CHECK_GL_ERRORS;
+    }
+    if (item.texture != 0) {
+      glUniform1i(locations->textureLayer, item.textureLayer);
+    }
+
+    uploadMeshUniforms( *locations, *item.node, viewMatrix, modelMatrix,
+                        item.texture != 0);
+    glDrawElements( GL_TRIANGLES, item.batch.numIndices, indexType,
+                    indexOffset(item.batch, indexSize));
+  }
+
+  if (program != nullptr) {
+    program->disable();
+  }
+  if (texture != 0) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  }
+  CHECK_GL_ERRORS;
+}
+
+//----------------------------------------------------------------------------------------
+void Pool::uploadStaticGeometry() {
+  const vector<Vertex> & vertices = m_staticGeometry.getVertices();
+  const vector<GLuint> & indices = m_staticGeometry.getIndices();
+
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo_staticVertexData);
+  glBufferData( GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex),
+                vertices.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // The element array binding is part of the VAO's state
+  glBindVertexArray(m_vao_staticData);
+  glBufferData( GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint),
+                indices.data(), GL_STATIC_DRAW);
+  glBindVertexArray(0);
+  CHECK_GL_ERRORS;
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * The ball's transform slots in between the node's parent and the node
+ * itself, as if it were the parent's translation.
+ */
+mat4 Pool::ballModelMatrix(const RenderItem & item) const {
+  mat4 ballTransform = m_snapshot->getBallTransform(item.ball, m_physicsAlpha);
+  const SceneNode * parent = item.node->parent;
+  if (parent) {
+    return parent->get_world_transform() * ballTransform * item.node->trans;
+  }
+  return ballTransform * item.node->trans;
+}
+
+//----------------------------------------------------------------------------------------
+// Byte offset of a batch's first index within its index buffer, whose indices
+// are indexSize bytes each
+const void * Pool::indexOffset(const BatchInfo & batch, size_t indexSize) {
+  return reinterpret_cast<const void *>(size_t(batch.startIndex) * indexSize);
+}
+
+//----------------------------------------------------------------------------------------
+bool Pool::isInstancedBall(const GeometryNode & node) const {
+  // The instanced shader has no texturing
+  return m_instancedBalls && node.meshId == BALL_MESH_ID &&
+         ! (node.isTextured() && m_texture);
+}
+
+//----------------------------------------------------------------------------------------
+void Pool::renderBallInstances() {
+  PROFILE_GPU_SCOPE("Balls");
+  const vector<RenderItem> & items = m_ballInstanceQueue.getItems();
+  if (items.empty()) {
+    return;
+  }
+
+  m_ballInstances.clear();
+  for (const RenderItem & item : items) {
+    mat4 model = ballModelMatrix(item);
+    if (! m_frustum.intersects(item.bounds.transformed(model))) {
+      continue;
+    }
+
+    BallInstance instance;
+    instance.model = model;
+    instance.kd = item.node->material.kd;
+    instance.ks = item.node->material.ks;
+    instance.shininess = item.node->material.shininess;
+    m_ballInstances.push_back(instance);
+  }
+  if (m_ballInstances.empty()) {
+    return;
+  }
+
+  // Upload this frame's instances, growing the buffer if needed and
+  // orphaning it otherwise so the driver needn't wait on the last frame
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo_ballInstances);
+  GLsizeiptr numBytes = m_ballInstances.size() * sizeof(BallInstance);
+  if (numBytes > m_ballInstanceCapacity) {
+    m_ballInstanceCapacity = numBytes;
+    glBufferData(GL_ARRAY_BUFFER, numBytes, m_ballInstances.data(), GL_STREAM_DRAW);
+  }
+  else {
+    glBufferData(GL_ARRAY_BUFFER, m_ballInstanceCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, numBytes, m_ballInstances.data());
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  CHECK_GL_ERRORS;
+
+  BatchInfo batchInfo = m_batchInfoMap[BALL_MESH_ID];
+
+  glBindVertexArray(m_vao_ballInstances);
+  m_ball_shader.enable();
+    glDrawElementsInstanced( GL_TRIANGLES, batchInfo.numIndices, m_indexType,
+                             indexOffset(batchInfo, m_indexSize), GLsizei(m_ballInstances.size()));
+  m_ball_shader.disable();
+  glBindVertexArray(0);
+  CHECK_GL_ERRORS;
 }
 
 //----------------------------------------------------------------------------------------
 void Pool::renderCrosshair() {
+  PROFILE_GPU_SCOPE("Crosshair");
   glBindVertexArray(m_vao_crosshair);
 
 	m_crosshair_shader.enable();
@@ -704,6 +1328,9 @@ void Pool::renderCrosshair() {
  */
 void Pool::cleanup()
 {
+  m_simulation.stop();
+  releaseTextureIdsHelper(*m_rootNode);
+  m_textureManager.clear();
 }
 
 //----------------------------------------------------------------------------------------
@@ -903,6 +1530,12 @@ bool Pool::handleKeyPress(int key) {
     }
     case 'T': {
       m_texture = ! m_texture;
+      m_isRenderQueueDirty = true;
+      eventHandled = true;
+      break;
+    }
+    case GLFW_KEY_F3: {
+      m_showProfiler = ! m_showProfiler;
       eventHandled = true;
       break;
     }
@@ -933,9 +1566,7 @@ void Pool::resetCamera() {
 
 //----------------------------------------------------------------------------------------
 void Pool::resetBalls() {
-  for (auto it = m_balls.begin(); it != m_balls.end(); it++) {
-    it->reset();
-  }
+  m_simulation.reset();
 }
 
 //----------------------------------------------------------------------------------------
@@ -995,97 +1626,18 @@ void Pool::updateTime() {
 
 //----------------------------------------------------------------------------------------
 void Pool::strikeCue() {
-  Ray ray = m_camera.getRay();
-  vector<vec3> intersections;
-  vector<Ball *> balls;
-  for (auto it = m_balls.begin(); it != m_balls.end(); it++) {
-    vec3 intersection;
-    if (it->hits(ray, intersection)) {
-      intersections.push_back(intersection);
-      balls.push_back(& * it);
-    }
-  }
-  
-  if (intersections.empty()) {
-    return; // nothing hit
-  }
-  
-  vec3 nearestIntersection = intersections.front();
-  Ball * nearestBall = balls.front();
-  float nearestDistance = length(nearestIntersection - ray.m_origin);
-  for (auto it = intersections.begin(); it != intersections.end(); it++) {
-    float distanceFromRay = length(*it - ray.m_origin);
-    if (distanceFromRay < nearestDistance) {
-      nearestDistance = distanceFromRay;
-      nearestIntersection = *it;
-      nearestBall = balls.at(it - intersections.begin());
-    }
-  }
-  
-  float cueDistance = 1.0f * UNITS_TO_METERS;
-  nearestBall->springForward(ray, cueDistance * m_strikePower);
+  m_simulation.strike(m_camera.getRay(), m_strikePower);
 }
 
+//----------------------------------------------------------------------------------------
+/*
+ * The simulation steps on its own thread; each frame picks up its latest
+ * snapshot and blends the balls between the snapshot's two states, by how far
+ * the clock is into the step it should be on screen for.
+ */
 void Pool::applyPhysics() {
-  for (auto it = m_balls.begin(); it != m_balls.end(); it++) {
-    bool isHit = false;
-
-    // Dynamic collision detection
-    for (auto it2 = it + 1; it2 != m_balls.end(); it2++) {
-      vec3 intersection;
-      if (it->hits(*it2, intersection)) {
-        vec3 normal = (it->m_center - it2->m_center) /
-                      length(it->m_center - it2->m_center);
-        vec3 velocityNormal1 = dot(it->m_velocity, -normal) * (-normal);
-        vec3 velocityNormal2 = dot(it2->m_velocity, normal) * normal;
-        vec3 velocityTangential1 = velocityNormal1 - it->m_velocity;
-        vec3 velocityTangential2 = velocityNormal2 - it2->m_velocity;
-        it->m_velocity = -velocityTangential1 + velocityNormal2;
-        it2->m_velocity = -velocityTangential2 + velocityNormal1;
-        isHit = true;
-        break; // assume a ball can only hit one thing at a time :)
-      }
-    }
-    
-    if (! isHit) { // assume a ball can only hit one thing at a time :)
-      // Static collision detection
-      for (auto it2 = m_edges.begin(); it2 != m_edges.end(); it2++) {
-        vec3 intersection;
-        if (it->hits(*it2, intersection)) {
-          /*
-          vec3 normal = it->m_center - intersection;
-          vec3 velocityNormal1 = dot(it->m_velocity, -normal) * (-normal);
-          vec3 velocityTangential1 = velocityNormal1 - it->m_velocity;
-          it->m_velocity = -velocityTangential1;
-          */
-          vec3 normal = it->m_center - intersection;
-          it->m_velocity =
-              ggReflection(it->m_velocity, normal) * length(it->m_velocity);
-          isHit = true;
-          break;
-        }
-      }
-    }
-    
-    if (! isHit) {
-      vec3 intersection;
-      //if (it->hits(m_poolsurface, intersection)) {
-        // if ball is falling (acceleration is negative)
-        //if (it->m_acceleration.y < 0.0f) {
-          // make it bounce
-          //it->m_acceleration.y =
-        //}
-      //}
-      //isHit = true;
-    }
-
-    it->applyPhysics(m_deltaTime);
-  }
-}
-
-vec3 Pool::ggReflection(const vec3 & direction, const vec3 & surfaceNormal) {
-  return normalize(direction) -
-         2.0f * ( dot(direction, surfaceNormal) /
-                  (length(direction) * length(surfaceNormal))) *
-         normalize(surfaceNormal);
+  PROFILE_SCOPE("applyPhysics");
+  m_snapshot = & m_simulation.getSnapshot();
+  double stepsAhead = (m_snapshot->time - Simulation::now()) / m_snapshot->timestep;
+  m_physicsAlpha = glm::clamp(1.0f - float(stepsAhead), 0.0f, 1.0f);
 }
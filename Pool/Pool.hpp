@@ -9,26 +9,59 @@
 #include "GeometryNode.hpp"
 #include "JointNode.hpp"
 
+#include "AssetLoader.hpp"
+#include "BoundingBox.hpp"
 #include "Camera.hpp"
+#include "Frustum.hpp"
+#include "RenderQueue.hpp"
+#include "StaticGeometry.hpp"
+#include "TextureManager.hpp"
 
 #include "KeyStates.hpp"
 #include "MouseStates.hpp"
 
-#include "Entity.hpp"
-#include "Ball.hpp"
-#include "Box.hpp"
+#include "physics/Simulation.hpp"
 
 #include <glm/glm.hpp>
 #include <memory>
-#include <stack>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 struct LightSource {
 	glm::vec3 position;
 	glm::vec3 rgbIntensity;
 };
 
+// Contents of the SceneUniforms block shared by every shader, in std140 layout
+// (vec4 rather than vec3, so there is no padding to get wrong)
+struct SceneUniforms {
+  glm::mat4 perspective;
+  glm::mat4 view;
+  glm::vec4 lightPosition;
+  glm::vec4 lightRgbIntensity;
+  glm::vec4 ambientIntensity;
+};
+
+// Locations of the uniforms set for every mesh drawn; -1 if a program has none
+struct MeshUniformLocations {
+  GLint modelView;
+  GLint normalMatrix;
+  GLint kd;
+  GLint ks;
+  GLint shininess;
+  GLint textureLayer; // -1 if the program is untextured
+};
+
+// Per-ball vertex attributes for instanced rendering
+struct BallInstance {
+  glm::mat4 model;
+  glm::vec3 kd;
+  glm::vec3 ks;
+  float shininess;
+};
+
 struct OscillatingTimer {
   float timer;
   float tick;
@@ -71,27 +104,45 @@ protected:
 	virtual bool keyInputEvent(int key, int action, int mods) override;
 
 	//-- One time initialization methods:
+	void loadAssets();
 	void processLuaSceneFile(const std::string & filename);
+	void preloadTextures(AssetLoader & loader);
+	void collectTextureFiles(const SceneNode & node, std::set<std::string> & filePaths);
+	void showLoadingProgress(size_t numLoaded, size_t numAssets);
 	void createShaderProgram();
 	void enableVertexShaderInputSlots();
 	void uploadVertexDataToVbos(const MeshConsolidator & meshConsolidator);
 	void mapVboDataToVertexShaderInputLocations();
+	void initBallInstancing();
+	void initStaticGeometry();
+	void initMeshBounds(const MeshConsolidator & meshConsolidator);
+	void initSceneUniforms();
 	void initLightSources();
 	void initPerspectiveMatrix();
 	void initTextureIds();
 	void initTextureIdsHelper(SceneNode & node);
+	void releaseTextureIdsHelper(SceneNode & node);
 	void initEntities();
 
   //-- Rendering
 	void uploadCommonSceneUniforms();
 	void renderSceneGraph(const SceneNode & node);
-	void renderSceneNode(const SceneNode & node,
-	                     std::stack<glm::mat4> & matStack);
-	void renderGeometryNode(const GeometryNode & node, glm::mat4 mat);
+	void buildRenderQueue(const SceneNode & root);
+	void buildRenderQueueHelper(const SceneNode & node);
+	void updateBounds(const SceneNode & node);
+	void cullSceneGraph(const SceneNode & node, bool isInside);
+	void renderRenderQueue(const RenderQueue & queue, bool isBaked);
+	void uploadStaticGeometry();
+	glm::mat4 ballModelMatrix(const RenderItem & item) const;
+	static const void * indexOffset(const BatchInfo & batch, size_t indexSize);
+	bool isInstancedBall(const GeometryNode & node) const;
+	void renderBallInstances();
 	void renderCrosshair();
 
   //-- ImGui Menus
   void showOptionsMenu();
+  void showTextureFilteringMenu();
+  void showProfilerWindow();
 
   //-- Application Menu
   void resetAll();
@@ -109,7 +160,7 @@ protected:
   // Functions called from Main Thread ONLY
   void updateTime();
   void lockCursorPos(); // reset cursor position back if locked
-  void applyPhysics();
+  void applyPhysics(); // pick up the simulation's latest snapshot
 
   // Camera Controls
   void rotateCamera(glm::vec2 mouseDelta);
@@ -117,9 +168,6 @@ protected:
 
   // Strike Cue
   void strikeCue();
-  
-  glm::vec3 ggReflection( const glm::vec3 & direction,
-                          const glm::vec3 & surfaceNormal);
 
   // Members =================================================================
 
@@ -129,20 +177,40 @@ protected:
 
 	//-- GL resources for mesh geometry data:
 	  GLuint m_vao_meshData;
-	  GLuint m_vbo_vertexPositions;
-	  GLuint m_vbo_vertexNormals;
-	  GLuint m_vbo_vertexTextureUVs;
+	  GLuint m_vbo_vertexData;    // interleaved Vertex data of every mesh
+	  GLuint m_ibo_vertexIndices; // triangles of every mesh
+	  GLenum m_indexType;         // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	  size_t m_indexSize;         // bytes per index
 
 	  //-- Basic shader
 	  GLint m_positionAttribLocation;
 	  GLint m_normalAttribLocation;	
 	  ShaderProgram m_shader;
+	  MeshUniformLocations m_shaderUniforms;
 
 	  //-- Texture Shader
 	  GLint m_texture_positionAttribLocation;
 	  GLint m_texture_normalAttribLocation;
 	  GLint m_texture_textureAttribLocation;
 	  ShaderProgram m_texture_shader;
+	  MeshUniformLocations m_texture_shaderUniforms;
+
+	  //-- Uniform buffer holding SceneUniforms, updated once per frame
+	  GLuint m_ubo_sceneUniforms;
+
+	  //-- Instanced ball shader: every ball in one draw call
+	  GLuint m_vao_ballInstances;
+	  GLuint m_vbo_ballInstances;
+	  GLsizeiptr m_ballInstanceCapacity; // bytes allocated for m_vbo_ballInstances
+	  ShaderProgram m_ball_shader;
+	  // Balls drawn by the instanced path, and their per-frame attributes
+	  RenderQueue m_ballInstanceQueue;
+	  std::vector<BallInstance> m_ballInstances;
+
+	  //-- Static geometry baked into world space (see StaticGeometry)
+	  GLuint m_vao_staticData;
+	  GLuint m_vbo_staticVertexData;
+	  GLuint m_ibo_staticIndices;
 	//--
 
   //-- GL resources for crosshair geometry:
@@ -155,6 +223,26 @@ protected:
 	// object. Each BatchInfo object contains an index offset and the number of indices
 	// required to render the mesh with identifier MeshId.
 	BatchInfoMap m_batchInfoMap;
+	// Map: MeshId -> bounds of the mesh's vertices, in model space
+	std::unordered_map<MeshId, BoundingBox> m_meshBounds;
+
+	// Everything else in the scene graph, sorted by GL state; rebuilt from the
+	// scene graph only when m_isRenderQueueDirty
+	RenderQueue m_renderQueue;
+	bool m_isRenderQueueDirty;
+	// Nodes that never move, baked into m_staticGeometry when the render queue
+	// is rebuilt; kept so it can be baked again
+	RenderQueue m_staticQueue;
+	StaticGeometry m_staticGeometry;
+	std::unique_ptr<MeshConsolidator> m_meshConsolidator;
+
+	// View frustum of the frame being drawn; nodes it found visible have
+	// lastVisibleFrame == m_frameCount
+	Frustum m_frustum;
+	unsigned int m_frameCount;
+
+	// Textures shared by all GeometryNodes, keyed by asset path
+	TextureManager m_textureManager;
 
 	std::string m_luaSceneFile;
 
@@ -168,6 +256,10 @@ protected:
 	bool m_backface_culling;
 	bool m_frontface_culling;
 	bool m_texture;
+	bool m_instancedBalls;
+	bool m_bakeStaticGeometry;
+	bool m_frustumCulling;
+	bool m_showProfiler;
 
   Camera m_camera; // Camera
 
@@ -182,11 +274,14 @@ protected:
   // Physics parameters
   glm::vec3 m_gravitationalAcceleration;
   float m_strikePower;
+
+  // Fixed-timestep simulation of the balls, cushions and playing surface,
+  // on its own thread
+  Simulation m_simulation;
+  int m_physicsHz; // physics steps per simulated second
+  const TableSnapshot * m_snapshot; // picked up for this frame
+  float m_physicsAlpha; // fraction of a step to interpolate rendering by
   
-  // Entities
-  std::vector<Ball> m_balls;
-  std::vector<Box> m_edges;
-  Box m_poolsurface;
-  // Map: geometry Node ID -> idx into m_balls
+  // Map: geometry Node ID -> idx into the simulated table's balls
   std::map<int, int> m_geoToBall;
 };
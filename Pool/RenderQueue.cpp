@@ -0,0 +1,35 @@
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+void RenderQueue::clear() {
+	m_items.clear();
+}
+
+//----------------------------------------------------------------------------------------
+void RenderQueue::push(const RenderItem & item) {
+	m_items.push_back(item);
+}
+
+//----------------------------------------------------------------------------------------
+void RenderQueue::sort() {
+	// Stable, so items that share all their state stay in scene graph order
+	stable_sort(m_items.begin(), m_items.end(),
+		[](const RenderItem & a, const RenderItem & b) {
+			if (a.program != b.program) {
+				return a.program < b.program;
+			}
+			if (a.texture != b.texture) {
+				return a.texture < b.texture;
+			}
+			return a.batch.startIndex < b.batch.startIndex;
+		});
+}
+
+//----------------------------------------------------------------------------------------
+const vector<RenderItem> & RenderQueue::getItems() const {
+	return m_items;
+}
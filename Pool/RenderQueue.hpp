@@ -0,0 +1,37 @@
+#pragma once
+
+#include "BoundingBox.hpp"
+#include "GeometryNode.hpp"
+
+#include "cs488-framework/BatchInfo.hpp"
+#include "cs488-framework/OpenGLImport.hpp"
+
+#include <vector>
+
+// A GeometryNode to draw, with the GL state it needs
+struct RenderItem {
+	const GeometryNode * node;
+	unsigned int program; // shader program, as numbered by the renderer
+	GLuint texture;       // array texture, 0 if drawn untextured
+	GLint textureLayer;   // layer of the array to sample
+	BatchInfo batch;      // range of the node's mesh in the vertex buffers
+	int ball;             // index of the ball the node follows, or -1
+	BoundingBox bounds;   // of the batch, before the model matrix is applied
+};
+
+/*
+ * The scene graph's GeometryNodes flattened into a list, so drawing a frame
+ * doesn't have to walk the tree. Once sorted by program, then texture, then
+ * mesh, consecutive items share as much GL state as possible.
+ */
+class RenderQueue {
+public:
+	void clear();
+	void push(const RenderItem & item);
+	void sort();
+
+	const std::vector<RenderItem> & getItems() const;
+
+protected:
+	std::vector<RenderItem> m_items;
+};
@@ -22,7 +22,10 @@ SceneNode::SceneNode(const std::string& name)
 	m_nodeType(NodeType::SceneNode),
 	trans(mat4()),
 	isSelected(false),
-	m_nodeId(nodeInstanceCount++)
+	parent(nullptr),
+	lastVisibleFrame(0),
+	m_nodeId(nodeInstanceCount++),
+	isWorldDirty(true)
 {
 
 }
@@ -33,10 +36,17 @@ SceneNode::SceneNode(const SceneNode & other)
 	: m_nodeType(other.m_nodeType),
 	  m_name(other.m_name),
 	  trans(other.trans),
-	  invtrans(other.invtrans)
+	  invtrans(other.invtrans),
+	  parent(nullptr),
+	  bounds(other.bounds),
+	  lastVisibleFrame(0),
+	  m_nodeId(nodeInstanceCount++),
+	  isWorldDirty(true)
 {
 	for(SceneNode * child : other.children) {
-		this->children.push_front(new SceneNode(*child));
+		SceneNode * copy = new SceneNode(*child);
+		copy->parent = this;
+		this->children.push_front(copy);
 	}
 }
 
@@ -51,6 +61,7 @@ SceneNode::~SceneNode() {
 void SceneNode::set_transform(const glm::mat4& m) {
 	trans = m;
 	invtrans = m;
+	invalidate_world();
 }
 
 //---------------------------------------------------------------------------------------
@@ -63,14 +74,60 @@ const glm::mat4& SceneNode::get_inverse() const {
 	return invtrans;
 }
 
+//---------------------------------------------------------------------------------------
+const glm::mat4& SceneNode::get_world_transform() const {
+	update_world();
+	return worldTrans;
+}
+
+//---------------------------------------------------------------------------------------
+const glm::mat4& SceneNode::get_world_inverse() const {
+	update_world();
+	return invWorldTrans;
+}
+
+//---------------------------------------------------------------------------------------
+void SceneNode::update_world() const {
+	if (! isWorldDirty) {
+		return;
+	}
+
+	if (parent) {
+		worldTrans = parent->get_world_transform() * trans;
+	}
+	else {
+		worldTrans = trans;
+	}
+	invWorldTrans = glm::inverse(worldTrans);
+	isWorldDirty = false;
+}
+
+//---------------------------------------------------------------------------------------
+void SceneNode::invalidate_world() {
+	// A node is only ever clean if its parent is, so the descendants of a
+	// dirty node are already dirty
+	if (isWorldDirty) {
+		return;
+	}
+
+	isWorldDirty = true;
+	for(SceneNode * child : children) {
+		child->invalidate_world();
+	}
+}
+
 //---------------------------------------------------------------------------------------
 void SceneNode::add_child(SceneNode* child) {
 	children.push_back(child);
+	child->parent = this;
+	child->invalidate_world();
 }
 
 //---------------------------------------------------------------------------------------
 void SceneNode::remove_child(SceneNode* child) {
 	children.remove(child);
+	child->parent = nullptr;
+	child->invalidate_world();
 }
 
 //---------------------------------------------------------------------------------------
@@ -92,17 +149,20 @@ void SceneNode::rotate(char axis, float angle) {
 	}
 	mat4 rot_matrix = glm::rotate(degreesToRadians(angle), rot_axis);
 	trans = rot_matrix * trans;
+	invalidate_world();
 }
 
 //---------------------------------------------------------------------------------------
 void SceneNode::scale(const glm::vec3 & amount) {
 	trans = glm::scale(amount) * trans;
 	scaleTrans = glm::scale(amount) * scaleTrans;
+	invalidate_world();
 }
 
 //---------------------------------------------------------------------------------------
 void SceneNode::translate(const glm::vec3& amount) {
 	trans = glm::translate(amount) * trans;
+	invalidate_world();
 }
 
 
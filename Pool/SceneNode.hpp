@@ -1,5 +1,6 @@
 #pragma once
 
+#include "BoundingBox.hpp"
 #include "Material.hpp"
 
 #include <glm/glm.hpp>
@@ -26,6 +27,11 @@ public:
     
   const glm::mat4& get_transform() const;
   const glm::mat4& get_inverse() const;
+
+  // Transform from this node's space to world space, and its inverse.
+  // Cached, and only recomputed after this node or an ancestor has moved.
+  const glm::mat4& get_world_transform() const;
+  const glm::mat4& get_world_inverse() const;
     
   void set_transform(const glm::mat4& m);
     
@@ -42,7 +48,8 @@ public:
 
 	bool isSelected;
     
-  // Transformations
+  // Transformations; change trans through set_transform(), rotate(), scale()
+  // and translate() so the cached world transforms are kept up to date
   glm::mat4 trans;
   glm::mat4 invtrans;
   
@@ -50,6 +57,13 @@ public:
   glm::mat4 scaleTrans;
     
   std::list<SceneNode*> children;
+  SceneNode * parent; // nullptr for the root
+
+  // World-space bounds of this node and its descendants, cached by
+  // Pool::updateBounds(); empty if none of them has any geometry
+  mutable BoundingBox bounds;
+  // Last frame in which Pool's frustum culling found the node visible
+  mutable unsigned int lastVisibleFrame;
 
 	NodeType m_nodeType;
 	std::string m_name;
@@ -57,6 +71,14 @@ public:
 
 
 private:
+	// Mark the world transforms of this node and its descendants stale
+	void invalidate_world();
+	void update_world() const;
+
+	mutable glm::mat4 worldTrans;
+	mutable glm::mat4 invWorldTrans;
+	mutable bool isWorldDirty;
+
 	// The number of SceneNode instances.
 	static unsigned int nodeInstanceCount;
 };
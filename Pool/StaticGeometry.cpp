@@ -0,0 +1,146 @@
+#include "StaticGeometry.hpp"
+
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace glm;
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+StaticGeometry::StaticGeometry(float cellSize)
+	: m_cellSize(cellSize)
+{}
+
+//----------------------------------------------------------------------------------------
+void StaticGeometry::bake(const vector<RenderItem> & items,
+		const MeshConsolidator & meshes)
+{
+	clear();
+
+	// Group the items, keeping each group in scene graph order
+	vector<vector<const RenderItem *>> groups;
+	for (const RenderItem & item : items) {
+		auto group = groups.begin();
+		while ( group != groups.end() &&
+		        ! (canMerge(*group->front(), item) &&
+		           getCell(*group->front()) == getCell(item)) )
+		{
+			group++;
+		}
+		if (group == groups.end()) {
+			groups.emplace_back();
+			group = groups.end() - 1;
+		}
+		group->push_back(& item);
+	}
+
+	for (const vector<const RenderItem *> & group : groups) {
+		RenderItem merged = *group.front();
+		merged.batch.startIndex = m_indices.size();
+		merged.bounds = BoundingBox();
+		for (const RenderItem * item : group) {
+			appendMesh(*item, meshes, merged.bounds);
+		}
+		merged.batch.numIndices = m_indices.size() - merged.batch.startIndex;
+		m_queue.push(merged);
+	}
+
+	m_queue.sort();
+}
+
+//----------------------------------------------------------------------------------------
+void StaticGeometry::clear() {
+	m_queue.clear();
+	m_vertices.clear();
+	m_indices.clear();
+}
+
+//----------------------------------------------------------------------------------------
+const RenderQueue & StaticGeometry::getQueue() const {
+	return m_queue;
+}
+
+//----------------------------------------------------------------------------------------
+const vector<Vertex> & StaticGeometry::getVertices() const {
+	return m_vertices;
+}
+
+//----------------------------------------------------------------------------------------
+const vector<GLuint> & StaticGeometry::getIndices() const {
+	return m_indices;
+}
+
+//----------------------------------------------------------------------------------------
+bool StaticGeometry::canMerge(const RenderItem & a, const RenderItem & b) {
+	if ( a.program != b.program || a.texture != b.texture ||
+	     (a.texture != 0 && a.textureLayer != b.textureLayer) )
+	{
+		return false;
+	}
+
+	// Textured programs take kd from the texture instead
+	const Material & ma = a.node->material;
+	const Material & mb = b.node->material;
+	return (a.texture != 0 || ma.kd == mb.kd) &&
+	       ma.ks == mb.ks && ma.shininess == mb.shininess;
+}
+
+//----------------------------------------------------------------------------------------
+glm::ivec2 StaticGeometry::getCell(const RenderItem & item) const {
+	vec3 center = item.bounds.transformed(item.node->get_world_transform()).getCenter();
+	// Cell borders sit half a cell off the origin, where scenes tend to be
+	// centered, so a table there doesn't get split in four
+	return ivec2( int(floor(center.x / m_cellSize + 0.5f)),
+	              int(floor(center.z / m_cellSize + 0.5f)) );
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * A mesh's vertices are contiguous in the consolidated data, so the range its
+ * indices span is exactly its vertices.
+ */
+void StaticGeometry::appendMesh(const RenderItem & item,
+		const MeshConsolidator & meshes, BoundingBox & bounds)
+{
+	const BatchInfo & batch = item.batch;
+	if (batch.numIndices == 0) {
+		return;
+	}
+
+	size_t end = batch.startIndex + batch.numIndices;
+	GLuint first = meshes.getIndex(batch.startIndex);
+	GLuint last = first;
+	for (size_t i = batch.startIndex; i < end; i++) {
+		first = std::min(first, meshes.getIndex(i));
+		last = std::max(last, meshes.getIndex(i));
+	}
+
+	mat4 world = item.node->get_world_transform();
+	mat3 normalMatrix = inverseTranspose(mat3(world));
+	const Vertex * source = meshes.getVertexDataPtr();
+	GLuint base = m_vertices.size();
+	for (GLuint i = first; i <= last; i++) {
+		Vertex vertex = source[i];
+		vertex.position = vec3(world * vec4(vertex.position, 1.0f));
+		vertex.normal = normalize(normalMatrix * vertex.normal);
+		m_vertices.push_back(vertex);
+		bounds.expand(vertex.position);
+	}
+
+	// A mirroring transform turns the triangles inside out; flip them back so
+	// face culling still sees them front facing
+	bool isMirrored = determinant(mat3(world)) < 0.0f;
+	for (size_t i = batch.startIndex; i + 2 < end; i += 3) {
+		m_indices.push_back(base + meshes.getIndex(i) - first);
+		if (isMirrored) {
+			m_indices.push_back(base + meshes.getIndex(i + 2) - first);
+			m_indices.push_back(base + meshes.getIndex(i + 1) - first);
+		}
+		else {
+			m_indices.push_back(base + meshes.getIndex(i + 1) - first);
+			m_indices.push_back(base + meshes.getIndex(i + 2) - first);
+		}
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "RenderQueue.hpp"
+
+#include "cs488-framework/MeshConsolidator.hpp"
+#include "cs488-framework/OpenGLImport.hpp"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/*
+ * The scene graph's immobile GeometryNodes, pre-transformed into world space
+ * and merged into one vertex and index buffer. Nodes drawn with the same
+ * program, texture and material end up in the same batch, so the whole
+ * static environment takes a handful of draw calls and no model matrices.
+ *
+ * Only nodes in the same cell of a grid over the XZ plane are merged, so that
+ * each batch stays small enough to be frustum culled on its own.
+ */
+class StaticGeometry {
+public:
+	explicit StaticGeometry(float cellSize = 100.0f);
+
+	// Replace the baked geometry with the given items, reading their meshes
+	// from the consolidated mesh data they were batched against
+	void bake(const std::vector<RenderItem> & items, const MeshConsolidator & meshes);
+	void clear();
+
+	// One item per merged batch, sorted like a RenderQueue. Each item's node is
+	// the first node merged into it, for its material; its batch is a range of
+	// getIndices(), and its bounds are in world space.
+	const RenderQueue & getQueue() const;
+	const std::vector<Vertex> & getVertices() const;
+	const std::vector<GLuint> & getIndices() const;
+
+protected:
+	// Whether the items can be drawn with the same GL state and uniforms
+	static bool canMerge(const RenderItem & a, const RenderItem & b);
+	// Grid cell holding the center of the item's bounds
+	glm::ivec2 getCell(const RenderItem & item) const;
+	// Append the item's triangles, in world space, to m_vertices / m_indices
+	void appendMesh( const RenderItem & item, const MeshConsolidator & meshes,
+	                 BoundingBox & bounds);
+
+	float m_cellSize;
+	RenderQueue m_queue;
+	std::vector<Vertex> m_vertices;
+	std::vector<GLuint> m_indices;
+};
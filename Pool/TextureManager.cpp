@@ -0,0 +1,305 @@
+#include "TextureManager.hpp"
+
+#include "cs488-framework/GlErrorCheck.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <tuple>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+// Number of levels in a full mip chain for an image of the given size
+static GLsizei numMipLevels(unsigned int width, unsigned int height) {
+  GLsizei levels = 1;
+  unsigned int size = width > height ? width : height;
+  while (size > 1) {
+    size /= 2;
+    levels++;
+  }
+  return levels;
+}
+
+// From EXT_texture_filter_anisotropic, core only since GL 4.6
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+//----------------------------------------------------------------------------------------
+TextureManager::Filtering::Filtering()
+  : mode(TRILINEAR),
+    anisotropy(8.0f),
+    lodBias(0.0f),
+    skippedLevels(0)
+{}
+
+//----------------------------------------------------------------------------------------
+TextureManager::TextureManager()
+  : m_maxAnisotropy(-1.0f),
+    m_nextHandle(1)
+{}
+
+//----------------------------------------------------------------------------------------
+TextureManager::~TextureManager()
+{}
+
+//----------------------------------------------------------------------------------------
+GLuint TextureManager::acquire(const std::string & filePath) {
+  uploadPreloaded();
+
+  auto it = m_textures.find(filePath);
+  if (it != m_textures.end()) {
+    it->second.refCount++;
+    return it->second.handle;
+  }
+
+  if (! m_decoder.decode(filePath, m_staging)) {
+    return 0;
+  }
+
+  GLuint arrayId = uploadArray(vector<const Image *>(1, & m_staging));
+  TextureEntry & entry = addEntry(filePath, arrayId, 0);
+  entry.refCount = 1;
+
+  return entry.handle;
+}
+
+//----------------------------------------------------------------------------------------
+void TextureManager::preload(Image && image) {
+  if (m_textures.find(image.filePath) != m_textures.end()) {
+    return;
+  }
+  for (const Image & preloaded : m_preloaded) {
+    if (preloaded.filePath == image.filePath) {
+      return;
+    }
+  }
+
+  m_preloaded.push_back(std::move(image));
+}
+
+//----------------------------------------------------------------------------------------
+void TextureManager::uploadPreloaded() {
+  // Group by size and channel count; each group becomes one array
+  typedef std::tuple<unsigned int, unsigned int, unsigned int> ArrayKey;
+  map<ArrayKey, vector<const Image *>> groups;
+  for (const Image & image : m_preloaded) {
+    groups[ArrayKey(image.width, image.height, image.channels())].push_back(& image);
+  }
+
+  for (auto it = groups.begin(); it != groups.end(); it++) {
+    const vector<const Image *> & images = it->second;
+    GLuint arrayId = uploadArray(images);
+    for (size_t layer = 0; layer < images.size(); layer++) {
+      addEntry(images[layer]->filePath, arrayId, GLint(layer));
+    }
+  }
+
+  m_preloaded.clear();
+}
+
+//----------------------------------------------------------------------------------------
+TextureManager::TextureEntry & TextureManager::addEntry(
+    const std::string & filePath, GLuint arrayId, GLint layer)
+{
+  TextureEntry & entry = m_textures[filePath];
+  entry.handle = m_nextHandle++;
+  entry.arrayId = arrayId;
+  entry.layer = layer;
+  entry.refCount = 0;
+  m_paths[entry.handle] = filePath;
+  m_arrays[arrayId].numTextures++;
+
+  return entry;
+}
+
+//----------------------------------------------------------------------------------------
+void TextureManager::setFiltering(const Filtering & filtering) {
+  m_filtering = filtering;
+
+  for (auto it = m_arrays.begin(); it != m_arrays.end(); it++) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, it->first);
+    applyFiltering(it->second.numLevels);
+  }
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  CHECK_GL_ERRORS;
+}
+
+//----------------------------------------------------------------------------------------
+const TextureManager::Filtering & TextureManager::getFiltering() const {
+  return m_filtering;
+}
+
+//----------------------------------------------------------------------------------------
+float TextureManager::getMaxAnisotropy() {
+  if (m_maxAnisotropy >= 0.0f) {
+    return m_maxAnisotropy;
+  }
+
+  m_maxAnisotropy = 1.0f;
+  GLint numExtensions = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, & numExtensions);
+  for (GLint i = 0; i < numExtensions; i++) {
+    const char * name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+    if ( string(name) == "GL_EXT_texture_filter_anisotropic" ||
+         string(name) == "GL_ARB_texture_filter_anisotropic" )
+    {
+      glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, & m_maxAnisotropy);
+      break;
+    }
+  }
+  CHECK_GL_ERRORS;
+
+  return m_maxAnisotropy;
+}
+
+//----------------------------------------------------------------------------------------
+void TextureManager::applyFiltering(GLint numLevels) {
+  GLint magFilter = GL_LINEAR;
+  GLint minFilter = GL_LINEAR_MIPMAP_LINEAR;
+  switch (m_filtering.mode) {
+    case Filtering::NEAREST:
+      magFilter = GL_NEAREST;
+      minFilter = GL_NEAREST_MIPMAP_NEAREST;
+      break;
+    case Filtering::BILINEAR:
+      minFilter = GL_LINEAR_MIPMAP_NEAREST;
+      break;
+    case Filtering::TRILINEAR:
+      break;
+  }
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, magFilter);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, minFilter);
+
+  // Always leave the coarsest level, however many are skipped
+  GLint baseLevel = std::min(std::max(m_filtering.skippedLevels, 0), numLevels - 1);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, baseLevel);
+  glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_LOD_BIAS, m_filtering.lodBias);
+
+  float maxAnisotropy = getMaxAnisotropy();
+  if (maxAnisotropy > 1.0f) {
+    float anisotropy = std::min(std::max(m_filtering.anisotropy, 1.0f), maxAnisotropy);
+    glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+  }
+  CHECK_GL_ERRORS;
+}
+
+//----------------------------------------------------------------------------------------
+void TextureManager::release(GLuint texture) {
+  auto pathIt = m_paths.find(texture);
+  if (pathIt == m_paths.end()) {
+    return;
+  }
+
+  auto it = m_textures.find(pathIt->second);
+  if (--(it->second.refCount) == 0) {
+    GLuint arrayId = it->second.arrayId;
+    m_textures.erase(it);
+    m_paths.erase(pathIt);
+
+    // The array goes once none of its layers is used
+    auto arrayIt = m_arrays.find(arrayId);
+    if (--(arrayIt->second.numTextures) == 0) {
+      glDeleteTextures(1, & arrayId);
+      CHECK_GL_ERRORS;
+      m_arrays.erase(arrayIt);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void TextureManager::clear() {
+  for (auto it = m_arrays.begin(); it != m_arrays.end(); it++) {
+    glDeleteTextures(1, & it->first);
+  }
+  CHECK_GL_ERRORS;
+  m_textures.clear();
+  m_paths.clear();
+  m_arrays.clear();
+  m_preloaded.clear();
+}
+
+//----------------------------------------------------------------------------------------
+size_t TextureManager::size() const {
+  return m_textures.size();
+}
+
+//----------------------------------------------------------------------------------------
+GLuint TextureManager::getArray(GLuint texture) const {
+  auto pathIt = m_paths.find(texture);
+  return pathIt == m_paths.end() ? 0 : m_textures.at(pathIt->second).arrayId;
+}
+
+//----------------------------------------------------------------------------------------
+GLint TextureManager::getLayer(GLuint texture) const {
+  auto pathIt = m_paths.find(texture);
+  return pathIt == m_paths.end() ? 0 : m_textures.at(pathIt->second).layer;
+}
+
+//----------------------------------------------------------------------------------------
+bool TextureManager::decode(const std::string & filePath, Image & out_image) {
+  static thread_local ImageDecoder decoder;
+  return decoder.decode(filePath, out_image);
+}
+
+//----------------------------------------------------------------------------------------
+GLuint TextureManager::uploadArray(const std::vector<const Image *> & images) {
+  const Image & first = *images.front();
+  GLenum internalFormat = first.channels() == 4 ? GL_RGBA8 : GL_RGB8;
+  GLsizei width = first.width;
+  GLsizei height = first.height;
+  GLsizei numLayers = GLsizei(images.size());
+  GLint numLevels = numMipLevels(width, height);
+
+  GLuint arrayId;
+  glGenTextures(1, & arrayId);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, arrayId);
+
+  // Allocate immutable storage for the whole mip chain when the driver supports
+  // it, otherwise fall back to mutable storage for the base level.
+#ifndef __APPLE__
+  if (glTexStorage3D != NULL) {
+    glTexStorage3D( GL_TEXTURE_2D_ARRAY, numLevels, internalFormat,
+                    width, height, numLayers);
+  }
+  else
+#endif
+  {
+    glTexImage3D( GL_TEXTURE_2D_ARRAY, 0, internalFormat, width, height, numLayers,
+                  0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+  }
+  CHECK_GL_ERRORS;
+
+  // Decoded rows are tightly packed
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  for (GLsizei layer = 0; layer < numLayers; layer++) {
+    const Image & image = *images[layer];
+    GLenum format = GL_RGB;
+    switch (image.format) {
+      case PixelFormat::RGB:  format = GL_RGB;  break;
+      case PixelFormat::RGBA: format = GL_RGBA; break;
+      case PixelFormat::BGR:  format = GL_BGR;  break;
+      case PixelFormat::BGRA: format = GL_BGRA; break;
+    }
+    glTexSubImage3D( GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1,
+                     format, GL_UNSIGNED_BYTE, image.pixels.data());
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  CHECK_GL_ERRORS;
+
+  // Generated from level 0, whatever base level the filtering then picks
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+  CHECK_GL_ERRORS;
+  applyFiltering(numLevels);
+
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+  TextureArray & array = m_arrays[arrayId];
+  array.numLevels = numLevels;
+  array.numTextures = 0;
+
+  return arrayId;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "ImageDecoder.hpp"
+
+#include "cs488-framework/OpenGLImport.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+  Shares GL textures between scene nodes.
+  Each image file is decoded and uploaded to the GPU only once, the first time
+  it is acquired; later acquisitions of the same path return the same texture
+  handle and bump its reference count.
+
+  Every texture is a layer of a GL_TEXTURE_2D_ARRAY. Preloaded images of the
+  same size and channel count are packed into the same array, so drawing
+  surfaces with different textures needn't rebind anything; the shader picks
+  the layer. Bind getArray(handle) and sample layer getLayer(handle).
+*/
+class TextureManager {
+public:
+  // How textures are sampled; applies to every texture
+  struct Filtering {
+    enum Mode {
+      NEAREST,   // nearest texel of the nearest mip level
+      BILINEAR,  // blend of 4 texels of the nearest mip level
+      TRILINEAR  // bilinear, blended between the two nearest mip levels
+    };
+
+    Filtering();
+
+    Mode mode;
+    float anisotropy;  // 1 for none; clamped to getMaxAnisotropy()
+    float lodBias;     // added to the mip level picked; > 0 is blurrier, but cheaper
+    int skippedLevels; // finest mip levels never sampled, to cap resolution
+  };
+
+  TextureManager();
+  ~TextureManager();
+
+  // Change the filtering of every texture, present and future
+  void setFiltering(const Filtering & filtering);
+  const Filtering & getFiltering() const;
+  // Highest anisotropy the driver supports; 1 if it doesn't support any
+  float getMaxAnisotropy();
+
+  // Decode the image at filePath; doesn't touch GL, so any thread may call it,
+  // and each thread reuses its own decoder. Returns false if the image could
+  // not be loaded.
+  static bool decode(const std::string & filePath, Image & out_image);
+  // Take a decoded image ahead of time, so acquiring its path doesn't have to
+  // load it. Preloaded images are packed into arrays and uploaded together by
+  // uploadPreloaded(), or by the next acquire(). The texture is then resident
+  // until acquired and released, or cleared.
+  void preload(Image && image);
+  void uploadPreloaded();
+
+  // Get the texture for the image at filePath, loading it on first use.
+  // Returns 0 if the image could not be loaded.
+  GLuint acquire(const std::string & filePath);
+  // Drop one reference to the texture; it is deleted once unreferenced
+  void release(GLuint texture);
+  // Delete all textures, regardless of their reference counts
+  void clear();
+  // Number of distinct textures currently resident on the GPU
+  size_t size() const;
+
+  // Array texture holding the texture, and its layer in it
+  GLuint getArray(GLuint texture) const;
+  GLint getLayer(GLuint texture) const;
+
+private:
+  struct TextureEntry {
+    GLuint handle;
+    GLuint arrayId;
+    GLint layer;
+    unsigned int refCount;
+  };
+
+  struct TextureArray {
+    GLint numLevels;          // in the mip chain
+    unsigned int numTextures; // entries still using a layer of it
+  };
+
+  // Upload the images, which must share their size and channel count, as the
+  // layers of a new array texture with a full mip chain
+  GLuint uploadArray(const std::vector<const Image *> & images);
+  // Add an entry for the image at filePath, in the given layer of an array
+  TextureEntry & addEntry(const std::string & filePath, GLuint arrayId, GLint layer);
+  // Set the filtering parameters of the bound array texture
+  void applyFiltering(GLint numLevels);
+
+  Filtering m_filtering;
+  float m_maxAnisotropy; // < 0 until queried
+
+  // Reused by acquire() for images that weren't preloaded
+  ImageDecoder m_decoder;
+  Image m_staging;
+
+  // Images waiting for uploadPreloaded()
+  std::vector<Image> m_preloaded;
+
+  // Map: asset file path -> texture
+  std::map<std::string, TextureEntry> m_textures;
+  // Map: texture handle -> asset file path
+  std::map<GLuint, std::string> m_paths;
+  // Map: array texture id -> array
+  std::map<GLuint, TextureArray> m_arrays;
+  GLuint m_nextHandle;
+};
@@ -0,0 +1,153 @@
+/*
+ * Compares ObjFileDecoder with the decoder it replaced: checks that both give
+ * the same output on the bundled meshes and on a generated high-poly sphere,
+ * and times them on each.
+ *
+ * Usage: ObjDecodeBench [segments [assetDir]]
+ *   segments: the sphere has segments^2 quads, i.e. 6 * segments^2 vertices
+ *             (default 600)
+ *   assetDir: where the bundled .obj files are (default Assets)
+ * Returns non-zero if the decoders disagree on any file.
+ */
+
+#include "OldObjFileDecoder.hpp"
+
+#include "cs488-framework/ObjFileDecoder.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace glm;
+using namespace std;
+
+static const char * BUNDLED_MESHES[] = {
+  "cube.obj",
+  "sphere.obj",
+  "texturedcube.obj",
+  "patterncube.obj",
+  "thickpatterncube.obj",
+  "longpatterncube.obj",
+  "widepatterncube.obj"
+};
+
+static const char * SPHERE_FILE = "bench-sphere.obj";
+static const int NUM_RUNS = 3; // best of
+
+struct DecodedMesh {
+  string name;
+  vector<vec3> positions;
+  vector<vec3> normals;
+  vector<vec2> uvCoords;
+};
+
+//----------------------------------------------------------------------------------------
+/*
+ * Unit UV sphere with v/vt/vn triangles, which both decoders can read
+ */
+static bool writeSphere(const char * filePath, int segments) {
+  FILE * file = fopen(filePath, "w");
+  if (! file) {
+    return false;
+  }
+
+  fprintf(file, "o benchSphere\n");
+  for (int i = 0; i <= segments; i++) {
+    float theta = pi<float>() * i / segments;
+    for (int j = 0; j <= segments; j++) {
+      float phi = two_pi<float>() * j / segments;
+      vec3 p(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+      fprintf(file, "v %f %f %f\n", p.x, p.y, p.z);
+      fprintf(file, "vn %f %f %f\n", p.x, p.y, p.z);
+      fprintf(file, "vt %f %f\n", float(j) / segments, float(i) / segments);
+    }
+  }
+
+  int rowLength = segments + 1;
+  for (int i = 0; i < segments; i++) {
+    for (int j = 0; j < segments; j++) {
+      // 1-based corners of the quad
+      int a = i * rowLength + j + 1;
+      int b = a + 1;
+      int c = a + rowLength;
+      int d = c + 1;
+      fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, c, c, c, b, b, b);
+      fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", b, b, b, c, c, c, d, d, d);
+    }
+  }
+
+  return fclose(file) == 0;
+}
+
+//----------------------------------------------------------------------------------------
+template <typename Decoder>
+static double timeDecode(const string & filePath, DecodedMesh & out_mesh) {
+  double bestMs = 0.0;
+  for (int run = 0; run < NUM_RUNS; run++) {
+    auto start = chrono::steady_clock::now();
+    Decoder::decode( filePath.c_str(), out_mesh.name, out_mesh.positions,
+                     out_mesh.normals, out_mesh.uvCoords);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    bestMs = run == 0 ? ms : std::min(bestMs, ms);
+  }
+  return bestMs;
+}
+
+//----------------------------------------------------------------------------------------
+static bool isSame(const DecodedMesh & a, const DecodedMesh & b) {
+  return a.name == b.name && a.positions == b.positions &&
+         a.normals == b.normals && a.uvCoords == b.uvCoords;
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * Returns false if the decoders disagree
+ */
+static bool compare(const string & filePath) {
+  DecodedMesh oldMesh, newMesh;
+  double oldMs = timeDecode<OldObjFileDecoder>(filePath, oldMesh);
+  double newMs = timeDecode<ObjFileDecoder>(filePath, newMesh);
+  bool same = isSame(oldMesh, newMesh);
+
+  printf( "%-28s %9zu vertices  old %9.2f ms  new %9.2f ms  x%5.1f  %s\n",
+          filePath.c_str(), newMesh.positions.size(), oldMs, newMs,
+          newMs > 0.0 ? oldMs / newMs : 0.0, same ? "same" : "DIFFERENT");
+  return same;
+}
+
+//----------------------------------------------------------------------------------------
+int main(int argc, char ** argv) {
+  int segments = argc > 1 ? atoi(argv[1]) : 600;
+  string assetDir = argc > 2 ? argv[2] : "Assets";
+  if (segments < 1) {
+    fprintf(stderr, "Usage: %s [segments [assetDir]]\n", argv[0]);
+    return 2;
+  }
+
+  bool allSame = true;
+  try {
+    for (const char * mesh : BUNDLED_MESHES) {
+      allSame = compare(assetDir + "/" + mesh) && allSame;
+    }
+
+    if (! writeSphere(SPHERE_FILE, segments)) {
+      fprintf(stderr, "Unable to write %s\n", SPHERE_FILE);
+      return 2;
+    }
+    allSame = compare(SPHERE_FILE) && allSame;
+    remove(SPHERE_FILE);
+  }
+  catch (const std::exception & e) {
+    fprintf(stderr, "%s\n", e.what());
+    remove(SPHERE_FILE);
+    return 2;
+  }
+
+  return allSame ? 0 : 1;
+}
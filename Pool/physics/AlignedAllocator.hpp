@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/*
+  Allocator for std::vector whose storage starts on an Alignment-byte
+  boundary, so SIMD kernels can use aligned loads and stores
+*/
+template <typename T, size_t Alignment = 16>
+class AlignedAllocator {
+  public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+      typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T * allocate(size_t n) {
+      void * memory = NULL;
+      if (posix_memalign(& memory, Alignment, n * sizeof(T)) != 0) {
+        throw std::bad_alloc();
+      }
+      return static_cast<T *>(memory);
+    }
+
+    void deallocate(T * p, size_t) {
+      free(p);
+    }
+};
+
+template <typename T, typename U, size_t Alignment>
+bool operator==( const AlignedAllocator<T, Alignment> &,
+                 const AlignedAllocator<U, Alignment> &)
+{
+  return true;
+}
+
+template <typename T, typename U, size_t Alignment>
+bool operator!=( const AlignedAllocator<T, Alignment> &,
+                 const AlignedAllocator<U, Alignment> &)
+{
+  return false;
+}
@@ -0,0 +1,108 @@
+#include "Ball.hpp"
+#include "floats.hpp"
+#include "polyroots.hpp"
+
+#include <iostream>
+#include <glm/gtx/io.hpp>
+
+using namespace glm;
+using namespace std;
+
+const float CUE_BALL_CONTACT_TIME = 0.01; // seconds
+const float BALL_MASS = 0.5; // kg
+const float BALL_SPRING_CONSTANT = 10; // kg * m / s^2
+//const float SLIDING_FRICTION_COEFF = 0.2; // on this order
+//const float ROLLING_FRICTION_COEFF = 0.01; // on this order
+const float Ball::FRICTION_COEFF = 1.8;
+//const float GRAVITY = 9.81;
+
+Ball::Ball(std::string name, glm::vec3 center, float radius)
+  : Entity(BALL, name), m_initial_center(center), m_radius(radius)
+{
+  reset();
+}
+
+void Ball::reset() {
+  //isRolling = false;
+  //isSliding = false;
+  //m_angularVelocity = vec3();
+  //m_acceleration = vec3();
+  //timer_sliding.set(0.0f);
+}
+
+bool Ball::hits( const Ray & ray, const vec3 & center,
+                 vec3 & out_intersection) const
+{
+  // Parametric equation of ray: p = a + t * (b - a)
+  vec3 a = ray.m_origin;
+  vec3 b = ray.m_direction + ray.m_origin;
+  vec3 c = center;
+  float r = m_radius;
+  
+  // Quadratic equation to solve for t:
+  double A = dot(b - a, b - a); // * t ^ 2
+  double B = 2.0 * dot(b - a, a - c); // * t
+  double C = dot(a - c, a - c) - pow(r, 2);
+  
+  double roots[2];
+  size_t numRoots = quadraticRoots(A, B, C, roots);
+  double t;
+  
+  if (numRoots == 0) {
+    return false;
+  }
+  else if (numRoots == 1){
+    t = roots[0];
+    
+    if (isNeg(t)) {
+      return false;
+    }
+  }
+  else { // numRoots == 2
+    bool isRoot0Valid = isPos(roots[0]);
+    bool isRoot1Valid = isPos(roots[1]);
+    
+    if (isRoot0Valid && isRoot1Valid) {
+      t = glm::min(roots[0], roots[1]);
+    }
+    else if (isRoot0Valid) {
+      t = roots[0];
+    }
+    else if (isRoot1Valid) {
+      t = roots[1];
+    }
+    else {
+      return false;
+    }
+  }
+
+  out_intersection = a + (b - a) * float(t);
+  return true;
+}
+
+vec3 Ball::getSpringVelocity( const Ray & ray, const vec3 & center,
+                              float cueSpringDistance) const
+{
+  vec3 simpleDirection = normalize(center - ray.m_origin);
+  simpleDirection.y = 0.0f;
+
+  return ( BALL_SPRING_CONSTANT * simpleDirection * cueSpringDistance *
+           CUE_BALL_CONTACT_TIME) /
+         BALL_MASS;
+}
+
+/*
+void Ball::addSpin( const Ray & ray, float cueSpringDistance,
+                    const vec3 & intersection)
+{
+  m_spinOrigin = intersection - m_center;
+  vec3 deltaAngularVelocity =
+      (5.0f / 2.0f) * (CUE_BALL_CONTACT_TIME / (BALL_MASS * m_radius)) *
+      (cross( m_spinOrigin,
+              BALL_SPRING_CONSTANT * ray.m_direction * cueSpringDistance));
+  m_angularVelocity += deltaAngularVelocity;
+  float slideTime = m_radius * length(m_angularVelocity);
+  timer_sliding.set(slideTime);
+  isSliding = true; // begin sliding
+}
+*/
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Entity.hpp"
+#include "Ray.hpp"
+
+#include <glm/glm.hpp>
+
+class Ball : public Entity {
+  public:
+    // Friction slows a ball by this fraction of its velocity per second
+    static const float FRICTION_COEFF;
+
+    Ball(std::string name, glm::vec3 center, float radius);
+    // Return whether the ray hits the ball when it is centered at center
+    bool hits( const Ray & ray, const glm::vec3 & center,
+               glm::vec3 & out_intersection) const;
+    // Velocity given by the cue to the ball when it is centered at center
+    glm::vec3 getSpringVelocity( const Ray & ray, const glm::vec3 & center,
+                                 float cueSpringDistance) const;
+    void addSpin( const Ray & ray, float cueSpringDistance, 
+                  const glm::vec3 & intersection);
+    void reset();
+    
+    // Position and velocity live in the table's BallState
+    glm::vec3 m_initial_center;
+    float m_radius;
+    
+    // Physics parameters
+    //glm::vec3 m_angularVelocity;
+    //glm::vec3 m_acceleration;
+    //glm::vec3 m_spinOrigin;
+    
+    //bool isSliding; // sliding after cue-strike
+    //bool isRolling; // rolling after sliding some time
+    //CountdownTimer timer_sliding; // timer for time spent sliding
+    
+};
@@ -0,0 +1,156 @@
+#include "BallState.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#define BALLSTATE_USE_SSE
+#endif
+
+using namespace glm;
+using namespace std;
+
+const float BallState::REST_SPEED = 1e-3f;
+
+//----------------------------------------------------------------------------------------
+BallState::BallState()
+  : m_size(0)
+{}
+
+//----------------------------------------------------------------------------------------
+size_t BallState::add(const vec3 & center, float radius) {
+  size_t ball = m_size;
+  reserveLanes(m_size + 1);
+  m_size++;
+
+  m_radius[ball] = radius;
+  place(ball, center);
+  return ball;
+}
+
+//----------------------------------------------------------------------------------------
+bool BallState::isAnyMoving() const {
+  return find(m_isMoving.begin(), m_isMoving.end(), 1) != m_isMoving.end();
+}
+
+//----------------------------------------------------------------------------------------
+void BallState::place(size_t ball, const vec3 & center) {
+  m_centerX[ball] = m_previousX[ball] = center.x;
+  m_centerY[ball] = m_previousY[ball] = center.y;
+  m_centerZ[ball] = m_previousZ[ball] = center.z;
+  setVelocity(ball, vec3(0.0f));
+}
+
+//----------------------------------------------------------------------------------------
+void BallState::setVelocity(size_t ball, const vec3 & velocity) {
+  m_velocityX[ball] = velocity.x;
+  m_velocityY[ball] = velocity.y;
+  m_velocityZ[ball] = velocity.z;
+  updateMoving(ball);
+}
+
+//----------------------------------------------------------------------------------------
+void BallState::savePreviousState() {
+  copy(m_centerX.begin(), m_centerX.end(), m_previousX.begin());
+  copy(m_centerY.begin(), m_centerY.end(), m_previousY.begin());
+  copy(m_centerZ.begin(), m_centerZ.end(), m_previousZ.begin());
+}
+
+//----------------------------------------------------------------------------------------
+void BallState::applyFriction(float frictionCoeff, float deltaTime) {
+  // v += - k * dt * v
+  scaleVelocities(1.0f - frictionCoeff * deltaTime);
+}
+
+//----------------------------------------------------------------------------------------
+void BallState::scaleVelocities(float factor) {
+  size_t numLanes = m_radius.size();
+  float * vx = m_velocityX.data();
+  float * vy = m_velocityY.data();
+  float * vz = m_velocityZ.data();
+
+#ifdef BALLSTATE_USE_SSE
+  const __m128 f = _mm_set1_ps(factor);
+  const __m128 rest2 = _mm_set1_ps(REST_SPEED * REST_SPEED);
+  for (size_t i = 0; i < numLanes; i += LANES) {
+    __m128 x = _mm_mul_ps(_mm_load_ps(vx + i), f);
+    __m128 y = _mm_mul_ps(_mm_load_ps(vy + i), f);
+    __m128 z = _mm_mul_ps(_mm_load_ps(vz + i), f);
+    _mm_store_ps(vx + i, x);
+    _mm_store_ps(vy + i, y);
+    _mm_store_ps(vz + i, z);
+
+    __m128 speed2 = _mm_add_ps( _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                _mm_mul_ps(z, z));
+    int moving = _mm_movemask_ps(_mm_cmpgt_ps(speed2, rest2));
+    for (size_t lane = 0; lane < LANES; lane++) {
+      m_isMoving[i + lane] = (moving >> lane) & 1;
+    }
+  }
+#else
+  for (size_t i = 0; i < numLanes; i++) {
+    vx[i] *= factor;
+    vy[i] *= factor;
+    vz[i] *= factor;
+    updateMoving(i);
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+void BallState::move(float deltaTime) {
+  size_t numLanes = m_radius.size();
+  float * px = m_centerX.data();
+  float * py = m_centerY.data();
+  float * pz = m_centerZ.data();
+  const float * vx = m_velocityX.data();
+  const float * vy = m_velocityY.data();
+  const float * vz = m_velocityZ.data();
+
+#ifdef BALLSTATE_USE_SSE
+  const __m128 dt = _mm_set1_ps(deltaTime);
+  for (size_t i = 0; i < numLanes; i += LANES) {
+    _mm_store_ps(px + i, _mm_add_ps( _mm_load_ps(px + i),
+                                     _mm_mul_ps(_mm_load_ps(vx + i), dt)));
+    _mm_store_ps(py + i, _mm_add_ps( _mm_load_ps(py + i),
+                                     _mm_mul_ps(_mm_load_ps(vy + i), dt)));
+    _mm_store_ps(pz + i, _mm_add_ps( _mm_load_ps(pz + i),
+                                     _mm_mul_ps(_mm_load_ps(vz + i), dt)));
+  }
+#else
+  for (size_t i = 0; i < numLanes; i++) {
+    px[i] += vx[i] * deltaTime;
+    py[i] += vy[i] * deltaTime;
+    pz[i] += vz[i] * deltaTime;
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------------------
+void BallState::reserveLanes(size_t count) {
+  size_t numLanes = (count + LANES - 1) / LANES * LANES;
+  if (numLanes <= m_radius.size()) {
+    return;
+  }
+
+  // New lanes hold balls at rest at the origin
+  m_centerX.resize(numLanes, 0.0f);
+  m_centerY.resize(numLanes, 0.0f);
+  m_centerZ.resize(numLanes, 0.0f);
+  m_previousX.resize(numLanes, 0.0f);
+  m_previousY.resize(numLanes, 0.0f);
+  m_previousZ.resize(numLanes, 0.0f);
+  m_velocityX.resize(numLanes, 0.0f);
+  m_velocityY.resize(numLanes, 0.0f);
+  m_velocityZ.resize(numLanes, 0.0f);
+  m_radius.resize(numLanes, 0.0f);
+  m_isMoving.resize(numLanes, 0);
+}
+
+//----------------------------------------------------------------------------------------
+void BallState::updateMoving(size_t ball) {
+  float speed2 = m_velocityX[ball] * m_velocityX[ball] +
+                 m_velocityY[ball] * m_velocityY[ball] +
+                 m_velocityZ[ball] * m_velocityZ[ball];
+  m_isMoving[ball] = speed2 > REST_SPEED * REST_SPEED;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "AlignedAllocator.hpp"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/*
+  Positions and velocities of every ball on a table, stored as a structure
+  of arrays: one contiguous, 16-byte aligned array per component. The
+  per-step kernels (friction, integration) run over the arrays four balls at
+  a time with SSE where it is available, and one at a time otherwise.
+
+  The arrays are padded with balls at rest to a multiple of LANES, so the
+  kernels never need a scalar tail.
+*/
+class BallState {
+  public:
+    typedef std::vector<float, AlignedAllocator<float>> FloatArray;
+    typedef std::vector<unsigned char> FlagArray;
+
+    // Balls processed together by the SIMD kernels
+    static const size_t LANES = 4;
+    // Balls slower than this are considered at rest
+    static const float REST_SPEED;
+
+    BallState();
+
+    // Add a ball at rest; returns its index
+    size_t add(const glm::vec3 & center, float radius);
+    size_t size() const;
+
+    glm::vec3 getCenter(size_t ball) const;
+    glm::vec3 getPreviousCenter(size_t ball) const;
+    glm::vec3 getVelocity(size_t ball) const;
+    float getRadius(size_t ball) const;
+    // Return whether the ball is moving faster than REST_SPEED
+    bool isMoving(size_t ball) const;
+    // Return whether any ball is moving faster than REST_SPEED
+    bool isAnyMoving() const;
+
+    // Place the ball at center, at rest, with no motion to interpolate
+    void place(size_t ball, const glm::vec3 & center);
+    void setVelocity(size_t ball, const glm::vec3 & velocity);
+
+    // Remember every center as the start of the next physics step
+    void savePreviousState();
+    // Slow every ball down by the friction acting over deltaTime
+    void applyFriction(float frictionCoeff, float deltaTime);
+    // Multiply every velocity by factor
+    void scaleVelocities(float factor);
+    // Move every ball along its velocity for deltaTime
+    void move(float deltaTime);
+
+  protected:
+    // Grow the arrays to hold at least count balls
+    void reserveLanes(size_t count);
+    // Refresh the moving flag of one ball from its velocity
+    void updateMoving(size_t ball);
+
+    size_t m_size;
+
+    FloatArray m_centerX, m_centerY, m_centerZ;
+    FloatArray m_previousX, m_previousY, m_previousZ;
+    FloatArray m_velocityX, m_velocityY, m_velocityZ;
+    FloatArray m_radius;
+    FlagArray m_isMoving;
+};
+
+// Accessors are inline, since the narrow phase calls them once per pair
+
+inline size_t BallState::size() const {
+  return m_size;
+}
+
+inline glm::vec3 BallState::getCenter(size_t ball) const {
+  return glm::vec3(m_centerX[ball], m_centerY[ball], m_centerZ[ball]);
+}
+
+inline glm::vec3 BallState::getPreviousCenter(size_t ball) const {
+  return glm::vec3(m_previousX[ball], m_previousY[ball], m_previousZ[ball]);
+}
+
+inline glm::vec3 BallState::getVelocity(size_t ball) const {
+  return glm::vec3(m_velocityX[ball], m_velocityY[ball], m_velocityZ[ball]);
+}
+
+inline float BallState::getRadius(size_t ball) const {
+  return m_radius[ball];
+}
+
+inline bool BallState::isMoving(size_t ball) const {
+  return m_isMoving[ball] != 0;
+}
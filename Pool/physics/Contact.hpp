@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+/*
+  A collision found during a physics step
+*/
+struct Contact {
+  enum ContactType { BALL_BALL, BALL_CUSHION };
+
+  ContactType type;
+  // Index of the ball
+  size_t ball;
+  // Index of the other ball (BALL_BALL) or of the cushion (BALL_CUSHION)
+  size_t other;
+  // Point of contact
+  glm::vec3 point;
+};
@@ -0,0 +1,76 @@
+#include "ContactCooldowns.hpp"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+ContactCooldowns::ContactCooldowns()
+  : m_numEntities(0)
+{}
+
+//----------------------------------------------------------------------------------------
+void ContactCooldowns::resize(size_t numEntities) {
+  m_numEntities = numEntities;
+  size_t numPairs = numEntities > 1 ? numEntities * (numEntities - 1) / 2 : 0;
+  m_timers.assign(numPairs, 0.0f);
+  m_isCooling.assign((numPairs + 31) / 32, 0);
+  m_coolingPairs.clear();
+}
+
+//----------------------------------------------------------------------------------------
+void ContactCooldowns::clear() {
+  for (auto it = m_coolingPairs.begin(); it != m_coolingPairs.end(); it++) {
+    m_timers[*it] = 0.0f;
+  }
+  fill(m_isCooling.begin(), m_isCooling.end(), 0);
+  m_coolingPairs.clear();
+}
+
+//----------------------------------------------------------------------------------------
+void ContactCooldowns::start(size_t a, size_t b, float time) {
+  size_t pair = pairIndex(a, b);
+  uint32_t bit = 1u << (pair % 32);
+  if (! (m_isCooling[pair / 32] & bit)) {
+    m_isCooling[pair / 32] |= bit;
+    m_coolingPairs.push_back(pair);
+  }
+  m_timers[pair] = time;
+}
+
+//----------------------------------------------------------------------------------------
+bool ContactCooldowns::isCooling(size_t a, size_t b) const {
+  size_t pair = pairIndex(a, b);
+  return (m_isCooling[pair / 32] >> (pair % 32)) & 1;
+}
+
+//----------------------------------------------------------------------------------------
+void ContactCooldowns::tick(float deltaTime) {
+  for (size_t i = 0; i < m_coolingPairs.size();) {
+    size_t pair = m_coolingPairs[i];
+    m_timers[pair] -= deltaTime;
+    if (m_timers[pair] > 0.0f) {
+      i++;
+      continue;
+    }
+
+    // Done cooling down; swap it out of the list
+    m_timers[pair] = 0.0f;
+    m_isCooling[pair / 32] &= ~(1u << (pair % 32));
+    m_coolingPairs[i] = m_coolingPairs.back();
+    m_coolingPairs.pop_back();
+  }
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * Row a of the upper triangle holds the pairs (a, a + 1) .. (a, n - 1), and
+ * is preceded by a * (2n - a - 1) / 2 pairs.
+ */
+size_t ContactCooldowns::pairIndex(size_t a, size_t b) const {
+  if (a > b) {
+    swap(a, b);
+  }
+  return a * (2 * m_numEntities - a - 1) / 2 + (b - a - 1);
+}
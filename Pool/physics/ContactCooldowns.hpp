@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+  Cooldowns between pairs of entities, indexed by their dense entity ids:
+  after two entities collide, the pair can be marked so it is not treated as
+  colliding again for a short time. Table skips cooling pairs that are still
+  touching, so a resolved impact is not resolved again at the same instant.
+
+  Pairs are laid out in a packed upper triangle; a bitset records which pairs
+  are cooling down, and a list of those pairs keeps tick() proportional to
+  the number of recent contacts rather than the number of pairs.
+*/
+class ContactCooldowns {
+  public:
+    ContactCooldowns();
+
+    // Make room for entity ids [0, numEntities); clears every cooldown
+    void resize(size_t numEntities);
+    // End every cooldown
+    void clear();
+
+    // Start (or restart) the cooldown of the pair (a, b), a != b
+    void start(size_t a, size_t b, float time);
+    // Return whether the pair (a, b) is still cooling down
+    bool isCooling(size_t a, size_t b) const;
+    // Count every cooldown down by deltaTime
+    void tick(float deltaTime);
+
+  protected:
+    size_t pairIndex(size_t a, size_t b) const;
+
+    size_t m_numEntities;
+    std::vector<float> m_timers; // remaining time of each pair
+    std::vector<uint32_t> m_isCooling; // one bit per pair
+    std::vector<size_t> m_coolingPairs; // pairs whose bit is set
+};
@@ -0,0 +1,7 @@
+#include "Entity.hpp"
+
+const size_t Entity::NO_ID = size_t(-1);
+
+Entity::Entity(EntityType type, std::string name)
+  : m_type(type), m_name(name), m_id(NO_ID)
+{}
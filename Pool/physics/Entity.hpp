@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 #include <glm/glm.hpp>
@@ -8,9 +9,13 @@ class Entity {
   public:
     enum EntityType { BALL, BOX };
 
+    // Id of an entity that has not been added to a table
+    static const size_t NO_ID;
+
     Entity(EntityType type, std::string name);
     virtual ~Entity() {};
     
     EntityType m_type;
     std::string m_name;
+    size_t m_id; // dense id given by the table the entity belongs to
 };
@@ -0,0 +1,92 @@
+#include "ShotEvaluator.hpp"
+#include "floats.hpp"
+
+#include <cmath>
+
+using namespace glm;
+using namespace std;
+
+const size_t ShotEvaluator::NO_BALL = size_t(-1);
+
+//----------------------------------------------------------------------------------------
+ShotEvaluator::ShotEvaluator(size_t numThreads)
+  : m_pool(numThreads), m_workers(m_pool.size())
+{}
+
+//----------------------------------------------------------------------------------------
+void ShotEvaluator::evaluate( const Table & table,
+                              const vector<CandidateShot> & candidates,
+                              vector<ShotOutcome> & out_outcomes, float maxTime)
+{
+  out_outcomes.resize(candidates.size());
+
+  m_pool.parallelFor(candidates.size(), [&](size_t i, size_t worker) {
+    // Copy assignment reuses the worker's buffers after the first candidate
+    m_workers[worker].table = table;
+    evaluateShot(candidates[i], maxTime, m_workers[worker], out_outcomes[i]);
+  });
+}
+
+//----------------------------------------------------------------------------------------
+void ShotEvaluator::evaluateShot( const CandidateShot & candidate, float maxTime,
+                                  WorkerState & worker, ShotOutcome & out_outcome)
+{
+  Table & table = worker.table;
+
+  // Candidates come from the caller; one naming no ball, or with no direction
+  // to normalize, would index past the balls or spread NaNs through the shot
+  vec3 direction(candidate.direction.x, 0.0f, candidate.direction.z);
+  out_outcome.isValid = candidate.ball < table.getState().size() &&
+                        isPos(length(direction)) && std::isfinite(candidate.power);
+  worker.events.clear();
+
+  if (out_outcome.isValid) {
+    // Hold the cue just behind the ball, pointing along the shot
+    direction = normalize(direction);
+    vec3 center = table.getState().getCenter(candidate.ball);
+    table.strike(candidate.ball, Ray(center - direction, direction), candidate.power);
+
+    table.simulateShot(worker.events, maxTime);
+  }
+
+  out_outcome.firstBallHit = NO_BALL;
+  out_outcome.numBallCollisions = 0;
+  out_outcome.numCushionCollisions = 0;
+  for (auto it = worker.events.begin(); it != worker.events.end(); it++) {
+    switch (it->type) {
+      case ShotEvent::BALL_BALL: {
+        out_outcome.numBallCollisions++;
+        if (out_outcome.firstBallHit == NO_BALL) {
+          if (it->ball == candidate.ball) {
+            out_outcome.firstBallHit = it->other;
+          }
+          else if (it->other == candidate.ball) {
+            out_outcome.firstBallHit = it->ball;
+          }
+        }
+        break;
+      }
+      case ShotEvent::BALL_CUSHION: {
+        out_outcome.numCushionCollisions++;
+        break;
+      }
+      case ShotEvent::BALL_STOP: {
+        break;
+      }
+    }
+  }
+
+  out_outcome.isSettled = table.isSettled();
+  if (! out_outcome.isSettled) {
+    out_outcome.duration = maxTime;
+  }
+  else {
+    out_outcome.duration = worker.events.empty() ? 0.0 : worker.events.back().time;
+  }
+
+  const BallState & state = table.getState();
+  out_outcome.finalCenters.resize(state.size());
+  for (size_t i = 0; i < state.size(); i++) {
+    out_outcome.finalCenters[i] = state.getCenter(i);
+  }
+}
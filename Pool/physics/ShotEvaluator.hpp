@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Table.hpp"
+#include "ThreadPool.hpp"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/*
+  A cue strike to try: the ball to strike, which way, and how hard
+*/
+struct CandidateShot {
+  size_t ball;
+  // Direction the cue pushes the ball in; only its XZ part matters
+  glm::vec3 direction;
+  // In [0, 1], fraction of the maximum cue spring distance, as for Table::strike
+  float power;
+};
+
+/*
+  What came of a candidate shot
+*/
+struct ShotOutcome {
+  // False if the candidate named no ball of the table, had no XZ direction or
+  // a non-finite power; it is then not simulated, and the outcome describes
+  // the table as it was
+  bool isValid;
+  // Index of the first ball the struck ball hit, or NO_BALL
+  size_t firstBallHit;
+  size_t numBallCollisions;
+  size_t numCushionCollisions;
+  // Seconds until the table settled, or maxTime if it never did
+  double duration;
+  bool isSettled;
+  // Where every ball came to rest, indexed like Table::getBalls()
+  std::vector<glm::vec3> finalCenters;
+};
+
+/*
+  Simulates many candidate shots from the same table in parallel, e.g. to
+  search for a good shot. Every worker thread strikes and simulates its own
+  copy of the table, so the table given to evaluate() is only ever read.
+*/
+class ShotEvaluator {
+  public:
+    static const size_t NO_BALL;
+
+    // numThreads: worker threads to use; 0 uses one per hardware thread
+    explicit ShotEvaluator(size_t numThreads = 0);
+
+    /*
+      Strike a copy of table with each candidate in turn, simulate it until
+      the table settles (or for maxTime seconds), and summarize the result.
+      out_outcomes: one outcome per candidate, in the same order
+    */
+    void evaluate( const Table & table,
+                   const std::vector<CandidateShot> & candidates,
+                   std::vector<ShotOutcome> & out_outcomes,
+                   float maxTime = 60.0f);
+
+  protected:
+    // Per-worker scratch space, reused between candidates
+    struct WorkerState {
+      Table table;
+      std::vector<ShotEvent> events;
+    };
+
+    static void evaluateShot( const CandidateShot & candidate, float maxTime,
+                              WorkerState & worker, ShotOutcome & out_outcome);
+
+    ThreadPool m_pool;
+    std::vector<WorkerState> m_workers;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+/*
+  Something that happened during a simulated shot
+*/
+struct ShotEvent {
+  enum EventType { BALL_BALL, BALL_CUSHION, BALL_STOP };
+
+  EventType type;
+  // Seconds since the start of the shot
+  double time;
+  // Index of the ball
+  size_t ball;
+  // Index of the other ball (BALL_BALL) or of the cushion (BALL_CUSHION)
+  size_t other;
+  // Point of contact; the ball's resting place for BALL_STOP
+  glm::vec3 point;
+};
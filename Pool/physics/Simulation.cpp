@@ -0,0 +1,150 @@
+#include "Simulation.hpp"
+
+#include <chrono>
+
+using namespace glm;
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+Simulation::Simulation()
+  : m_isStopping(false), m_stepsPerSecond(120)
+{}
+
+//----------------------------------------------------------------------------------------
+Simulation::~Simulation() {
+  stop();
+}
+
+//----------------------------------------------------------------------------------------
+void Simulation::start(const Table & table, int stepsPerSecond) {
+  stop();
+
+  m_table = table;
+  m_stepsPerSecond = stepsPerSecond;
+  Command command;
+  while (m_commands.pop(command)) {}
+
+  // Nothing else touches the buffers yet, so they can all be filled in
+  publishSnapshot(now(), 1.0f / float(stepsPerSecond));
+  m_snapshots.update();
+  m_snapshots.reset(m_snapshots.getReadBuffer());
+
+  m_isStopping = false;
+  m_thread = thread(& Simulation::run, this);
+}
+
+//----------------------------------------------------------------------------------------
+void Simulation::stop() {
+  if (m_thread.joinable()) {
+    m_isStopping = true;
+    m_thread.join();
+  }
+}
+
+//----------------------------------------------------------------------------------------
+bool Simulation::isRunning() const {
+  return m_thread.joinable();
+}
+
+//----------------------------------------------------------------------------------------
+void Simulation::setStepsPerSecond(int stepsPerSecond) {
+  m_stepsPerSecond = stepsPerSecond;
+}
+
+//----------------------------------------------------------------------------------------
+bool Simulation::strike(const Ray & ray, float power) {
+  Command command;
+  command.type = Command::STRIKE;
+  command.origin = ray.m_origin;
+  command.direction = ray.m_direction;
+  command.power = power;
+  return m_commands.push(command);
+}
+
+//----------------------------------------------------------------------------------------
+bool Simulation::reset() {
+  Command command;
+  command.type = Command::RESET;
+  return m_commands.push(command);
+}
+
+//----------------------------------------------------------------------------------------
+const TableSnapshot & Simulation::getSnapshot() {
+  m_snapshots.update();
+  return m_snapshots.getReadBuffer();
+}
+
+//----------------------------------------------------------------------------------------
+double Simulation::now() {
+  return chrono::duration<double>(
+      chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * Step the table whenever the clock passes the time of the next step. The
+ * state after a step is published to be shown one step later, so rendering
+ * always has the two states to blend between.
+ */
+void Simulation::run() {
+  double nextStep = now();
+
+  while (! m_isStopping) {
+    float timestep = 1.0f / float(m_stepsPerSecond);
+    applyCommands();
+
+    int substeps = 0;
+    while (nextStep <= now() && substeps < MAX_SUBSTEPS) {
+      m_table.savePreviousState();
+      m_table.step(timestep);
+      nextStep += timestep;
+      substeps++;
+    }
+
+    if (nextStep <= now()) {
+      nextStep = now(); // fell behind; drop the backlog
+    }
+
+    if (substeps > 0) {
+      publishSnapshot(nextStep, timestep);
+    }
+
+    this_thread::sleep_until(chrono::steady_clock::time_point(
+        chrono::duration_cast<chrono::steady_clock::duration>(
+            chrono::duration<double>(nextStep))));
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void Simulation::applyCommands() {
+  Command command;
+  while (m_commands.pop(command)) {
+    switch (command.type) {
+      case Command::STRIKE:
+        m_table.strike(Ray(command.origin, command.direction), command.power);
+        break;
+      case Command::RESET:
+        m_table.reset();
+        break;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void Simulation::publishSnapshot(double time, float timestep) {
+  TableSnapshot & snapshot = m_snapshots.getWriteBuffer();
+  const vector<Ball> & balls = m_table.getBalls();
+  const BallState & state = m_table.getState();
+
+  snapshot.previousOffsets.resize(balls.size());
+  snapshot.offsets.resize(balls.size());
+  for (size_t i = 0; i < balls.size(); i++) {
+    snapshot.previousOffsets[i] = state.getPreviousCenter(i) - balls[i].m_initial_center;
+    snapshot.offsets[i] = state.getCenter(i) - balls[i].m_initial_center;
+  }
+  snapshot.time = time;
+  snapshot.timestep = timestep;
+  snapshot.isSettled = m_table.isSettled();
+
+  m_snapshots.publish();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Ray.hpp"
+#include "SpscQueue.hpp"
+#include "Table.hpp"
+#include "TableSnapshot.hpp"
+#include "TripleBuffer.hpp"
+
+#include <atomic>
+#include <thread>
+
+/*
+  Steps a Table at a fixed rate on a thread of its own, so a slow or
+  vsync-blocked frame doesn't hold up the physics, and a burst of collisions
+  doesn't hold up the frame.
+
+  After every step the balls are copied into a TableSnapshot and published
+  through a triple buffer, which the render thread reads without waiting.
+  Input goes the other way as commands on a lock-free queue, applied before
+  the next step. Only one thread may send commands and read snapshots.
+*/
+class Simulation {
+  public:
+    // Steps taken at once, at most, to catch up after falling behind; any
+    // time beyond that is dropped (the simulation slows down rather than
+    // spiralling)
+    static const int MAX_SUBSTEPS = 8;
+
+    Simulation();
+    ~Simulation();
+
+    // Start stepping a copy of the table on a new thread
+    void start(const Table & table, int stepsPerSecond);
+    // Stop the thread; the next start() begins afresh
+    void stop();
+    bool isRunning() const;
+
+    void setStepsPerSecond(int stepsPerSecond);
+
+    // Commands, applied before the next step. Return false if too many are
+    // already waiting and the command was dropped.
+    // Strike the ball nearest along the ray with the cue (see Table::strike)
+    bool strike(const Ray & ray, float power);
+    // Put every ball back at its initial position (see Table::reset)
+    bool reset();
+
+    // Latest published snapshot; it stays valid until the next call
+    const TableSnapshot & getSnapshot();
+
+    // Seconds on the clock snapshots are timed with
+    static double now();
+
+  protected:
+    struct Command {
+      enum Type { STRIKE, RESET };
+      Type type;
+      glm::vec3 origin;    // of the cue's ray
+      glm::vec3 direction;
+      float power;
+    };
+
+    void run();
+    void applyCommands();
+    // Copy the table into the write buffer and publish it
+    void publishSnapshot(double time, float timestep);
+
+    // Owned by the simulation thread while it runs
+    Table m_table;
+    std::thread m_thread;
+    std::atomic<bool> m_isStopping;
+    std::atomic<int> m_stepsPerSecond;
+
+    SpscQueue<Command, 64> m_commands;
+    TripleBuffer<TableSnapshot> m_snapshots;
+
+    Simulation(const Simulation &);
+    Simulation & operator=(const Simulation &);
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/*
+  Lock-free bounded FIFO between exactly one producer thread and one consumer
+  thread. Each end only ever writes its own counter, so pushing and popping
+  need no locks; a full queue rejects pushes rather than blocking.
+*/
+template <typename T, size_t CAPACITY>
+class SpscQueue {
+  public:
+    SpscQueue();
+
+    // Append item; returns false if the queue is full (producer only)
+    bool push(const T & item);
+    // Take the oldest item; returns false if the queue is empty (consumer only)
+    bool pop(T & out_item);
+
+  protected:
+    T m_items[CAPACITY];
+    // Items pushed and popped so far; they only grow, and wrap around safely
+    std::atomic<size_t> m_numPushed;
+    std::atomic<size_t> m_numPopped;
+
+    SpscQueue(const SpscQueue &);
+    SpscQueue & operator=(const SpscQueue &);
+};
+
+//----------------------------------------------------------------------------------------
+template <typename T, size_t CAPACITY>
+SpscQueue<T, CAPACITY>::SpscQueue()
+  : m_numPushed(0), m_numPopped(0)
+{}
+
+//----------------------------------------------------------------------------------------
+template <typename T, size_t CAPACITY>
+bool SpscQueue<T, CAPACITY>::push(const T & item) {
+  size_t numPushed = m_numPushed.load(std::memory_order_relaxed);
+  if (numPushed - m_numPopped.load(std::memory_order_acquire) == CAPACITY) {
+    return false;
+  }
+
+  m_items[numPushed % CAPACITY] = item;
+  m_numPushed.store(numPushed + 1, std::memory_order_release);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T, size_t CAPACITY>
+bool SpscQueue<T, CAPACITY>::pop(T & out_item) {
+  size_t numPopped = m_numPopped.load(std::memory_order_relaxed);
+  if (numPopped == m_numPushed.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  out_item = m_items[numPopped % CAPACITY];
+  m_numPopped.store(numPopped + 1, std::memory_order_release);
+  return true;
+}
@@ -0,0 +1,407 @@
+#include "Table.hpp"
+#include "TimeOfImpact.hpp"
+#include "floats.hpp"
+
+#include <glm/gtx/norm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace glm;
+using namespace std;
+
+const float UNITS_TO_METERS = 1200.0f; // convert from opengl distance to meters
+const float HIT_COOLDOWN = 0.1f; // time before can collide with same object again
+// Give up resolving impacts in a step after this many per ball
+const size_t MAX_IMPACTS_PER_BALL = 16;
+// Give up simulating a shot after this many events per ball
+const size_t MAX_SHOT_EVENTS_PER_BALL = 1000;
+
+//----------------------------------------------------------------------------------------
+Table::Table()
+  : m_hasSurface(false), m_maxRadius(0.0f), m_isGridDirty(true)
+{}
+
+//----------------------------------------------------------------------------------------
+size_t Table::addBall(const Ball & ball) {
+  m_balls.push_back(ball);
+  m_balls.back().m_id = nextEntityId();
+  m_state.add(ball.m_initial_center, ball.m_radius);
+  if (ball.m_radius > m_maxRadius) {
+    m_maxRadius = ball.m_radius;
+    m_isGridDirty = true;
+  }
+  return m_balls.size() - 1;
+}
+
+//----------------------------------------------------------------------------------------
+void Table::addCushion(const Box & cushion) {
+  m_cushions.push_back(cushion);
+  m_cushions.back().m_id = nextEntityId();
+  m_isGridDirty = true;
+}
+
+//----------------------------------------------------------------------------------------
+void Table::setSurface(const Box & surface) {
+  m_surface = surface;
+  m_hasSurface = true;
+  m_isGridDirty = true;
+}
+
+//----------------------------------------------------------------------------------------
+void Table::reset() {
+  for (size_t i = 0; i < m_balls.size(); i++) {
+    m_balls[i].reset();
+    m_state.place(i, m_balls[i].m_initial_center);
+  }
+  m_cooldowns.clear();
+}
+
+//----------------------------------------------------------------------------------------
+void Table::savePreviousState() {
+  m_state.savePreviousState();
+}
+
+//----------------------------------------------------------------------------------------
+void Table::step(float timestep) {
+  m_contacts.clear();
+
+  m_state.applyFriction(Ball::FRICTION_COEFF, timestep);
+
+  // Jump from one impact to the next until the step is used up
+  float remaining = timestep;
+  size_t maxImpacts = MAX_IMPACTS_PER_BALL * m_balls.size();
+  for (size_t impacts = 0; impacts < maxImpacts; impacts++) {
+    Contact contact;
+    float time;
+    if (! findEarliestContact(remaining, contact, time)) {
+      break;
+    }
+    advance(time);
+    remaining -= time;
+    resolveContact(contact);
+    m_contacts.push_back(contact);
+  }
+  advance(remaining);
+
+  m_cooldowns.tick(timestep);
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * Friction gives every ball v(t) = v0 * e^(-k t), so
+ *   p(t) = p0 + v0 * s(t),  where s(t) = (1 - e^(-k t)) / k.
+ * As k is the same for every ball, all balls move linearly in s between
+ * events, and the time-of-impact sweeps can be done in s (with each ball's
+ * velocity at the last event) and converted back to time.
+ */
+void Table::simulateShot(vector<ShotEvent> & out_events, float maxTime) {
+  const double k = Ball::FRICTION_COEFF;
+  out_events.clear();
+
+  for (size_t i = 0; i < m_balls.size(); i++) {
+    if (! m_state.isMoving(i)) {
+      m_state.setVelocity(i, vec3(0.0f));
+    }
+  }
+
+  double time = 0.0;
+  size_t maxEvents = MAX_SHOT_EVENTS_PER_BALL * m_balls.size();
+  while (time < maxTime && out_events.size() < maxEvents) {
+    // Next ball to slow down to rest
+    double eventTime = maxTime - time;
+    bool isMoving = false;
+    bool isStop = false;
+    size_t stoppingBall = 0;
+    for (size_t i = 0; i < m_balls.size(); i++) {
+      float speed = length(m_state.getVelocity(i));
+      if (speed == 0.0f) {
+        continue;
+      }
+      isMoving = true;
+      double stopTime = std::max(0.0, log(speed / BallState::REST_SPEED) / k);
+      if (stopTime < eventTime) {
+        eventTime = stopTime;
+        isStop = true;
+        stoppingBall = i;
+      }
+    }
+    if (! isMoving) {
+      break;
+    }
+
+    // Next collision before then, if any
+    Contact contact;
+    float s;
+    float maxS = float((1.0 - exp(-k * eventTime)) / k);
+    bool isHit = findEarliestContact(maxS, contact, s);
+    if (isHit) {
+      eventTime = (k * s < 1.0) ? - log(1.0 - k * s) / k : eventTime;
+    }
+    else {
+      s = maxS;
+    }
+
+    // Move everything to the event
+    advance(s);
+    m_state.scaleVelocities(float(exp(-k * eventTime)));
+    m_cooldowns.tick(float(eventTime));
+    time += eventTime;
+
+    ShotEvent event;
+    event.time = time;
+    if (isHit) {
+      resolveContact(contact);
+      event.type = contact.type == Contact::BALL_BALL ?
+                   ShotEvent::BALL_BALL : ShotEvent::BALL_CUSHION;
+      event.ball = contact.ball;
+      event.other = contact.other;
+      event.point = contact.point;
+    }
+    else if (isStop) {
+      m_state.setVelocity(stoppingBall, vec3(0.0f));
+      event.type = ShotEvent::BALL_STOP;
+      event.ball = stoppingBall;
+      event.other = stoppingBall;
+      event.point = m_state.getCenter(stoppingBall);
+    }
+    else {
+      break; // out of time
+    }
+    out_events.push_back(event);
+  }
+
+  savePreviousState();
+}
+
+//----------------------------------------------------------------------------------------
+void Table::updateGrid() {
+  // Bound the cushions and surface in the XZ plane
+  vector<const Box *> boxes;
+  for (auto it = m_cushions.begin(); it != m_cushions.end(); it++) {
+    boxes.push_back(& * it);
+  }
+  if (m_hasSurface) {
+    boxes.push_back(& m_surface);
+  }
+
+  vec2 minCorner(0.0f);
+  vec2 maxCorner(0.0f);
+  for (auto it = boxes.begin(); it != boxes.end(); it++) {
+    vec2 center((*it)->m_center.x, (*it)->m_center.z);
+    vec2 halfExtents((*it)->m_extents.x / 2.0f, (*it)->m_extents.z / 2.0f);
+    if (it == boxes.begin()) {
+      minCorner = center - halfExtents;
+      maxCorner = center + halfExtents;
+    }
+    minCorner = glm::min(minCorner, center - halfExtents);
+    maxCorner = glm::max(maxCorner, center + halfExtents);
+  }
+
+  // Touching balls must lie in neighbouring cells
+  float cellSize = std::max(2.0f * m_maxRadius, 1e-3f);
+  m_grid.setBounds(minCorner, maxCorner, cellSize);
+  m_grid.insertCushions(m_cushions, m_maxRadius);
+  m_isGridDirty = false;
+}
+
+//----------------------------------------------------------------------------------------
+size_t Table::nextEntityId() {
+  size_t numEntities = m_balls.size() + m_cushions.size();
+  m_cooldowns.resize(numEntities);
+  return numEntities - 1;
+}
+
+//----------------------------------------------------------------------------------------
+bool Table::findEarliestContact( float maxTime, Contact & out_contact,
+                                 float & out_time)
+{
+  if (m_isGridDirty) {
+    updateGrid();
+  }
+  m_grid.insertBalls(m_state, maxTime);
+
+  bool isHit = false;
+  out_time = maxTime;
+  float time;
+
+  // Dynamic collision detection
+  m_ballPairs.clear();
+  m_grid.findBallPairs(m_ballPairs);
+  for (auto it = m_ballPairs.begin(); it != m_ballPairs.end(); it++) {
+    size_t i = it->first;
+    size_t j = it->second;
+    if ( sphereSphereTimeOfImpact( m_state.getCenter(i), m_state.getVelocity(i),
+                                   m_state.getRadius(i), m_state.getCenter(j),
+                                   m_state.getVelocity(j), m_state.getRadius(j),
+                                   out_time, time) &&
+         (! isHit || time < out_time))
+    {
+      // A pair still touching right after its impact was resolved can be
+      // pushed back together by the other balls of a cluster; let it come
+      // apart instead of resolving it again and again at the same instant
+      if (time == 0.0f && m_cooldowns.isCooling(m_balls[i].m_id, m_balls[j].m_id)) {
+        continue;
+      }
+      isHit = true;
+      out_time = time;
+      out_contact.type = Contact::BALL_BALL;
+      out_contact.ball = it->first;
+      out_contact.other = it->second;
+    }
+  }
+
+  // Static collision detection
+  vec3 point;
+  for (size_t i = 0; i < m_balls.size(); i++) {
+    vec3 center = m_state.getCenter(i);
+    vec3 velocity = m_state.getVelocity(i);
+    float radius = m_state.getRadius(i);
+    m_nearbyCushions.clear();
+    m_grid.findCushions(i, m_nearbyCushions);
+    for (auto it = m_nearbyCushions.begin(); it != m_nearbyCushions.end(); it++) {
+      if ( sphereBoxTimeOfImpact( center, velocity, radius, m_cushions[*it],
+                                  out_time, time, point) &&
+           (! isHit || time < out_time))
+      {
+        isHit = true;
+        out_time = time;
+        out_contact.type = Contact::BALL_CUSHION;
+        out_contact.ball = i;
+        out_contact.other = *it;
+        out_contact.point = point;
+      }
+    }
+  }
+
+  if (isHit && out_contact.type == Contact::BALL_BALL) {
+    // Touching point, once the balls have moved to the time of impact
+    size_t i = out_contact.ball;
+    size_t j = out_contact.other;
+    vec3 center = m_state.getCenter(i) + m_state.getVelocity(i) * out_time;
+    vec3 otherCenter = m_state.getCenter(j) + m_state.getVelocity(j) * out_time;
+    out_contact.point = center + normalize(otherCenter - center) *
+                        m_state.getRadius(i);
+  }
+
+  return isHit;
+}
+
+//----------------------------------------------------------------------------------------
+void Table::advance(float time) {
+  m_state.move(time);
+}
+
+//----------------------------------------------------------------------------------------
+void Table::resolveContact(const Contact & contact) {
+  size_t i = contact.ball;
+  vec3 center = m_state.getCenter(i);
+  vec3 velocity = m_state.getVelocity(i);
+
+  switch (contact.type) {
+    case Contact::BALL_BALL: {
+      size_t j = contact.other;
+      vec3 otherCenter = m_state.getCenter(j);
+      vec3 otherVelocity = m_state.getVelocity(j);
+      m_cooldowns.start(m_balls[i].m_id, m_balls[j].m_id, HIT_COOLDOWN);
+      vec3 normal = (center - otherCenter) / length(center - otherCenter);
+      vec3 velocityNormal1 = dot(velocity, -normal) * (-normal);
+      vec3 velocityNormal2 = dot(otherVelocity, normal) * normal;
+      vec3 velocityTangential1 = velocityNormal1 - velocity;
+      vec3 velocityTangential2 = velocityNormal2 - otherVelocity;
+      m_state.setVelocity(i, -velocityTangential1 + velocityNormal2);
+      m_state.setVelocity(j, -velocityTangential2 + velocityNormal1);
+      break;
+    }
+    case Contact::BALL_CUSHION: {
+      if (isZero(length(velocity))) {
+        break; // nothing to reflect
+      }
+      vec3 normal = center - contact.point;
+      m_state.setVelocity(i, ggReflection(velocity, normal) * length(velocity));
+      break;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+bool Table::strike(const Ray & ray, float power) {
+  bool isHit = false;
+  size_t nearestBall = 0;
+  float nearestDistance = 0.0f;
+  for (size_t i = 0; i < m_balls.size(); i++) {
+    vec3 intersection;
+    if (m_balls[i].hits(ray, m_state.getCenter(i), intersection)) {
+      float distanceFromRay = length(intersection - ray.m_origin);
+      if (! isHit || distanceFromRay < nearestDistance) {
+        isHit = true;
+        nearestDistance = distanceFromRay;
+        nearestBall = i;
+      }
+    }
+  }
+
+  if (! isHit) {
+    return false; // nothing hit
+  }
+
+  strike(nearestBall, ray, power);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+void Table::strike(size_t ball, const Ray & ray, float power) {
+  float cueDistance = 1.0f * UNITS_TO_METERS;
+  vec3 center = m_state.getCenter(ball);
+  m_state.setVelocity(ball, m_state.getVelocity(ball) +
+      m_balls[ball].getSpringVelocity(ray, center, cueDistance * power));
+}
+
+//----------------------------------------------------------------------------------------
+bool Table::isSettled() const {
+  return ! m_state.isAnyMoving();
+}
+
+//----------------------------------------------------------------------------------------
+const std::vector<Contact> & Table::getContacts() const {
+  return m_contacts;
+}
+
+//----------------------------------------------------------------------------------------
+mat4 Table::getBallTransform(size_t ball, float alpha) const {
+  vec3 center = mix(m_state.getPreviousCenter(ball), m_state.getCenter(ball), alpha);
+  return glm::translate(center - m_balls[ball].m_initial_center);
+}
+
+//----------------------------------------------------------------------------------------
+const std::vector<Ball> & Table::getBalls() const {
+  return m_balls;
+}
+
+//----------------------------------------------------------------------------------------
+BallState & Table::getState() {
+  return m_state;
+}
+
+//----------------------------------------------------------------------------------------
+const BallState & Table::getState() const {
+  return m_state;
+}
+
+//----------------------------------------------------------------------------------------
+const std::vector<Box> & Table::getCushions() const {
+  return m_cushions;
+}
+
+//----------------------------------------------------------------------------------------
+const Box & Table::getSurface() const {
+  return m_surface;
+}
+
+//----------------------------------------------------------------------------------------
+vec3 Table::ggReflection(const vec3 & direction, const vec3 & surfaceNormal) {
+  return normalize(direction) -
+         2.0f * ( dot(direction, surfaceNormal) /
+                  (length(direction) * length(surfaceNormal))) *
+         normalize(surfaceNormal);
+}
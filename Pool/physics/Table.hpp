@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Ball.hpp"
+#include "BallState.hpp"
+#include "Box.hpp"
+#include "Contact.hpp"
+#include "ContactCooldowns.hpp"
+#include "Ray.hpp"
+#include "ShotEvent.hpp"
+#include "UniformGrid.hpp"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/*
+  State of a pool table: the balls, the cushions they bounce off, and the
+  playing surface. Has no dependency on GLFW or OpenGL, so shots can be
+  simulated without a window.
+*/
+class Table {
+  public:
+    Table();
+
+    // Add a ball to the table; returns its index
+    size_t addBall(const Ball & ball);
+    // Add a cushion that balls bounce off
+    void addCushion(const Box & cushion);
+    // Set the playing surface
+    void setSurface(const Box & surface);
+
+    // Put every ball back at its initial position, at rest
+    void reset();
+    // Remember the current state of every ball as the start of the next step
+    void savePreviousState();
+    /*
+      Advance the table by one physics step of the given length (in seconds).
+      Collisions are found continuously: the table is advanced to the earliest
+      impact within the step, the impact is resolved, and so on, so fast balls
+      cannot pass through each other or the cushions.
+    */
+    void step(float timestep);
+    /*
+      Simulate the rest of the shot in one go: every ball is moved straight to
+      the next collision or to the moment a ball comes to rest, using the
+      closed-form solution of the friction model, until the table settles or
+      maxTime seconds have passed. Leaves the table in its final state.
+      out_events: every collision and stop, in the order they happened
+    */
+    void simulateShot(std::vector<ShotEvent> & out_events, float maxTime = 60.0f);
+    /*
+      Strike the ball nearest along the ray with the cue
+      power: in [0, 1], fraction of the maximum cue spring distance
+      Returns false if the ray misses every ball
+    */
+    bool strike(const Ray & ray, float power);
+    // Strike the given ball with the cue held along the ray
+    void strike(size_t ball, const Ray & ray, float power);
+    // Return whether every ball has come to rest
+    bool isSettled() const;
+
+    // Contacts resolved during the last step, in the order they happened
+    const std::vector<Contact> & getContacts() const;
+
+    // Rendering transform of a ball, blended between the last two physics
+    // steps (alpha = 0 gives the previous step, alpha = 1 the current one)
+    glm::mat4 getBallTransform(size_t ball, float alpha) const;
+
+    const std::vector<Ball> & getBalls() const;
+    // Positions and velocities of the balls, indexed like getBalls()
+    BallState & getState();
+    const BallState & getState() const;
+    const std::vector<Box> & getCushions() const;
+    const Box & getSurface() const;
+
+  protected:
+    // Rebuild the broadphase grid over the cushions and surface
+    void updateGrid();
+    // Id for the entity just added; resizes the cooldowns to fit it
+    size_t nextEntityId();
+    /*
+      Find the earliest ball-ball or ball-cushion impact within maxTime
+      Returns false if nothing collides in that time
+    */
+    bool findEarliestContact(float maxTime, Contact & out_contact,
+                             float & out_time);
+    // Move every ball along its velocity for the given time
+    void advance(float time);
+    // Apply the collision response for a contact
+    void resolveContact(const Contact & contact);
+
+    // Reflect direction about the surface normal (both need not be unit length)
+    static glm::vec3 ggReflection( const glm::vec3 & direction,
+                                   const glm::vec3 & surfaceNormal);
+
+    std::vector<Ball> m_balls; // names, radii, initial positions
+    BallState m_state;
+    std::vector<Box> m_cushions;
+    Box m_surface;
+    bool m_hasSurface;
+    float m_maxRadius; // radius of the largest ball
+
+    // Cooldowns after ball-ball impacts, by entity id; a pair still touching
+    // while its cooldown runs is not resolved again
+    ContactCooldowns m_cooldowns;
+
+    // Broadphase
+    UniformGrid m_grid;
+    bool m_isGridDirty; // grid must be rebuilt before the next step
+
+    std::vector<Contact> m_contacts;
+    // Scratch space reused between steps
+    std::vector<std::pair<size_t, size_t>> m_ballPairs;
+    std::vector<size_t> m_nearbyCushions;
+};
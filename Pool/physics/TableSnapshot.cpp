@@ -0,0 +1,15 @@
+#include "TableSnapshot.hpp"
+
+#include <glm/gtx/transform.hpp>
+
+using namespace glm;
+
+//----------------------------------------------------------------------------------------
+TableSnapshot::TableSnapshot()
+  : time(0.0), timestep(0.0f), isSettled(true)
+{}
+
+//----------------------------------------------------------------------------------------
+mat4 TableSnapshot::getBallTransform(size_t ball, float alpha) const {
+  return glm::translate(mix(previousOffsets[ball], offsets[ball], alpha));
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/*
+  What rendering needs of a Table after a physics step, copied out so the
+  simulation can carry on stepping the table while it is drawn.
+*/
+struct TableSnapshot {
+  TableSnapshot();
+
+  // Rendering transform of a ball, blended between the step's start
+  // (alpha = 0) and its end (alpha = 1)
+  glm::mat4 getBallTransform(size_t ball, float alpha) const;
+
+  // Translation of each ball from its initial center, at the start and end
+  // of the step
+  std::vector<glm::vec3> previousOffsets;
+  std::vector<glm::vec3> offsets;
+  // Simulation::now() at which the end of the step should be on screen
+  double time;
+  float timestep; // length of the step, in seconds
+  bool isSettled; // every ball is at rest
+};
@@ -0,0 +1,141 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+ThreadPool::ThreadPool(size_t numThreads)
+  : m_task(NULL), m_batch(0), m_numBusy(0),
+    m_isStopping(false)
+{
+  if (numThreads == 0) {
+    numThreads = std::max(1u, thread::hardware_concurrency());
+  }
+
+  for (size_t i = 0; i < numThreads; i++) {
+    m_workers.push_back(unique_ptr<Worker>(new Worker()));
+  }
+  for (size_t i = 0; i < numThreads; i++) {
+    m_threads.push_back(thread(& ThreadPool::workerLoop, this, i));
+  }
+}
+
+//----------------------------------------------------------------------------------------
+ThreadPool::~ThreadPool() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_isStopping = true;
+  }
+  m_wakeWorkers.notify_all();
+
+  for (auto it = m_threads.begin(); it != m_threads.end(); it++) {
+    it->join();
+  }
+}
+
+//----------------------------------------------------------------------------------------
+size_t ThreadPool::size() const {
+  return m_workers.size();
+}
+
+//----------------------------------------------------------------------------------------
+void ThreadPool::parallelFor( size_t numTasks,
+                              const function<void(size_t, size_t)> & task)
+{
+  if (numTasks == 0) {
+    return;
+  }
+
+  // Deal the tasks out in contiguous runs, so neighbouring tasks share a
+  // worker unless they get stolen
+  size_t numWorkers = m_workers.size();
+  for (size_t w = 0; w < numWorkers; w++) {
+    lock_guard<mutex> lock(m_workers[w]->mutex);
+    size_t first = numTasks * w / numWorkers;
+    size_t last = numTasks * (w + 1) / numWorkers;
+    for (size_t i = first; i < last; i++) {
+      m_workers[w]->tasks.push_back(i);
+    }
+  }
+
+  unique_lock<mutex> lock(m_mutex);
+  m_task = & task;
+  m_numBusy = numWorkers;
+  m_exception = exception_ptr();
+  m_batch++;
+  m_wakeWorkers.notify_all();
+
+  // Waiting for every worker, not just every task, makes sure no worker
+  // still holds on to this batch's task when the next batch starts
+  m_batchDone.wait(lock, [this] { return m_numBusy == 0; });
+  m_task = NULL;
+
+  if (m_exception) {
+    exception_ptr exception = m_exception;
+    m_exception = exception_ptr();
+    rethrow_exception(exception);
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void ThreadPool::workerLoop(size_t worker) {
+  size_t lastBatch = 0;
+
+  while (true) {
+    const function<void(size_t, size_t)> * task;
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_wakeWorkers.wait(lock, [&] { return m_isStopping || m_batch != lastBatch; });
+      if (m_isStopping) {
+        return;
+      }
+      lastBatch = m_batch;
+      task = m_task;
+    }
+
+    size_t i;
+    while (popTask(worker, i)) {
+      try {
+        (*task)(i, worker);
+      }
+      catch (...) {
+        lock_guard<mutex> lock(m_mutex);
+        if (! m_exception) {
+          m_exception = current_exception();
+        }
+      }
+    }
+
+    lock_guard<mutex> lock(m_mutex);
+    if (--m_numBusy == 0) {
+      m_batchDone.notify_all();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+bool ThreadPool::popTask(size_t worker, size_t & out_task) {
+  {
+    Worker & own = *m_workers[worker];
+    lock_guard<mutex> lock(own.mutex);
+    if (! own.tasks.empty()) {
+      out_task = own.tasks.back();
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  // Steal, starting from the next worker along
+  size_t numWorkers = m_workers.size();
+  for (size_t k = 1; k < numWorkers; k++) {
+    Worker & victim = *m_workers[(worker + k) % numWorkers];
+    lock_guard<mutex> lock(victim.mutex);
+    if (! victim.tasks.empty()) {
+      out_task = victim.tasks.front();
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+  Fixed set of worker threads running batches of independent tasks.
+
+  Each worker has its own deque of task indices. A worker pops tasks from the
+  back of its own deque, and once that is empty, steals from the front of the
+  others' deques. Long tasks on one worker are then picked up by the others
+  instead of leaving them idle.
+*/
+class ThreadPool {
+  public:
+    // Start numThreads workers; 0 uses one per hardware thread
+    explicit ThreadPool(size_t numThreads = 0);
+    ~ThreadPool();
+
+    // Number of workers
+    size_t size() const;
+
+    /*
+      Call task(i, worker) for every i in [0, numTasks) on the workers, and
+      wait until all calls return. worker is the index of the worker making
+      the call, in [0, size()), so tasks can use per-worker scratch space.
+      If a task throws, the first exception is rethrown here once the batch
+      is done. Only one batch runs at a time: don't call this from a task, or
+      from several threads at once.
+    */
+    void parallelFor( size_t numTasks,
+                      const std::function<void(size_t, size_t)> & task);
+
+  protected:
+    struct Worker {
+      std::mutex mutex;
+      std::deque<size_t> tasks;
+    };
+
+    void workerLoop(size_t worker);
+    // Take a task from the worker's own deque, or steal one from another's
+    bool popTask(size_t worker, size_t & out_task);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    // Guards everything below
+    std::mutex m_mutex;
+    std::condition_variable m_wakeWorkers;
+    std::condition_variable m_batchDone;
+    const std::function<void(size_t, size_t)> * m_task;
+    size_t m_batch; // incremented for every batch
+    // Workers still running tasks of the batch; each one stops being busy
+    // once it finds no task left to run or steal
+    size_t m_numBusy;
+    std::exception_ptr m_exception;
+    bool m_isStopping;
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool & operator=(const ThreadPool &);
+};
@@ -0,0 +1,189 @@
+#include "TimeOfImpact.hpp"
+#include "polyroots.hpp"
+
+#include <glm/gtx/norm.hpp>
+
+using namespace glm;
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+/*
+ * Earliest time a point at p moving with velocity v enters the circle of the
+ * given radius around c, or false if it doesn't within [0, maxTime].
+ * p must start outside the circle.
+ */
+static bool pointCircleTimeOfImpact( const vec2 & p, const vec2 & v,
+                                     const vec2 & c, float radius,
+                                     float maxTime, float & out_time)
+{
+  vec2 d = p - c;
+
+  // |d + v * t|^2 = radius^2
+  double A = dot(v, v);
+  double B = 2.0 * dot(v, d);
+  double C = dot(d, d) - radius * radius;
+  if (A == 0.0) {
+    return false; // no relative motion
+  }
+
+  double roots[2];
+  size_t numRoots = quadraticRoots(A, B, C, roots);
+  if (numRoots == 0) {
+    return false;
+  }
+
+  // Entering is the smaller root
+  double t = roots[0];
+  if (numRoots == 2 && roots[1] < t) {
+    t = roots[1];
+  }
+  if (t < 0.0 || t > maxTime) {
+    return false;
+  }
+
+  out_time = float(t);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+bool sphereSphereTimeOfImpact(
+    const vec3 & center1, const vec3 & velocity1, float radius1,
+    const vec3 & center2, const vec3 & velocity2, float radius2,
+    float maxTime, float & out_time)
+{
+  vec3 d = center1 - center2;
+  vec3 w = velocity1 - velocity2;
+  float r = radius1 + radius2;
+
+  if (dot(d, w) >= 0.0f) {
+    return false; // not approaching
+  }
+
+  if (length2(d) <= r * r) {
+    out_time = 0.0f; // already touching
+    return true;
+  }
+
+  // |d + w * t|^2 = r^2
+  double A = dot(w, w);
+  double B = 2.0 * dot(w, d);
+  double C = dot(d, d) - r * r;
+
+  double roots[2];
+  size_t numRoots = quadraticRoots(A, B, C, roots);
+  if (numRoots == 0) {
+    return false; // they pass each other
+  }
+
+  double t = roots[0];
+  if (numRoots == 2 && roots[1] < t) {
+    t = roots[1];
+  }
+  if (t < 0.0 || t > maxTime) {
+    return false;
+  }
+
+  out_time = float(t);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * The set of centers at which the sphere touches the box footprint is the
+ * footprint grown by the radius, with rounded corners. It is the union of two
+ * rectangles (the footprint grown along x, and along z) and four circles
+ * around the corners, so the earliest impact is the earliest entry into any
+ * of them.
+ */
+bool sphereBoxTimeOfImpact(
+    const vec3 & center, const vec3 & velocity, float radius,
+    const Box & box, float maxTime, float & out_time, vec3 & out_point)
+{
+  vec2 p(center.x, center.z);
+  vec2 v(velocity.x, velocity.z);
+  vec2 lo(box.m_center.x - box.m_extents.x / 2.0f,
+          box.m_center.z - box.m_extents.z / 2.0f);
+  vec2 hi(box.m_center.x + box.m_extents.x / 2.0f,
+          box.m_center.z + box.m_extents.z / 2.0f);
+
+  // Already touching?
+  vec2 closest = clamp(p, lo, hi);
+  vec2 normal = p - closest;
+  if (length2(normal) <= radius * radius) {
+    if (normal == vec2(0.0f)) {
+      // Center is inside the footprint; push out through the nearest side
+      float toLeft = p.x - lo.x;
+      float toRight = hi.x - p.x;
+      float toBack = p.y - lo.y;
+      float toFront = hi.y - p.y;
+      float nearest = glm::min(glm::min(toLeft, toRight), glm::min(toBack, toFront));
+      if (nearest == toLeft) {
+        normal = vec2(-1.0f, 0.0f);
+        closest.x = lo.x;
+      }
+      else if (nearest == toRight) {
+        normal = vec2(1.0f, 0.0f);
+        closest.x = hi.x;
+      }
+      else if (nearest == toBack) {
+        normal = vec2(0.0f, -1.0f);
+        closest.y = lo.y;
+      }
+      else {
+        normal = vec2(0.0f, 1.0f);
+        closest.y = hi.y;
+      }
+    }
+    if (dot(v, normal) >= 0.0f) {
+      return false; // separating
+    }
+    out_time = 0.0f;
+    out_point = vec3(closest.x, center.y, closest.y);
+    return true;
+  }
+
+  bool isHit = false;
+  float t;
+
+  // Sides facing along x
+  if (v.x != 0.0f) {
+    float sideX = v.x > 0.0f ? lo.x : hi.x;
+    t = (sideX + (v.x > 0.0f ? - radius : radius) - p.x) / v.x;
+    float z = p.y + v.y * t;
+    if (t >= 0.0f && t <= maxTime && z >= lo.y && z <= hi.y) {
+      isHit = true;
+      out_time = t;
+      out_point = vec3(sideX, center.y, z);
+    }
+  }
+
+  // Sides facing along z
+  if (v.y != 0.0f) {
+    float sideZ = v.y > 0.0f ? lo.y : hi.y;
+    t = (sideZ + (v.y > 0.0f ? - radius : radius) - p.y) / v.y;
+    float x = p.x + v.x * t;
+    if ( t >= 0.0f && t <= maxTime && x >= lo.x && x <= hi.x &&
+         (! isHit || t < out_time))
+    {
+      isHit = true;
+      out_time = t;
+      out_point = vec3(x, center.y, sideZ);
+    }
+  }
+
+  // Corners
+  const vec2 corners[4] = {
+    lo, vec2(hi.x, lo.y), hi, vec2(lo.x, hi.y)
+  };
+  for (size_t i = 0; i < 4; i++) {
+    if ( pointCircleTimeOfImpact(p, v, corners[i], radius, maxTime, t) &&
+         (! isHit || t < out_time))
+    {
+      isHit = true;
+      out_time = t;
+      out_point = vec3(corners[i].x, center.y, corners[i].y);
+    }
+  }
+
+  return isHit;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Box.hpp"
+
+#include <glm/glm.hpp>
+
+/*
+  Time of impact between moving shapes, for continuous collision detection.
+
+  Motion is linear: a shape at p moving with velocity v is at p + v * t at
+  time t. Each function returns true and sets out_time to the earliest time in
+  [0, maxTime] at which the shapes touch while approaching each other; shapes
+  that already touch but are separating do not collide.
+*/
+
+bool sphereSphereTimeOfImpact(
+    const glm::vec3 & center1, const glm::vec3 & velocity1, float radius1,
+    const glm::vec3 & center2, const glm::vec3 & velocity2, float radius2,
+    float maxTime, float & out_time);
+
+/*
+  The box is treated as the prism over its XZ footprint (cushions stand taller
+  than the balls), so only motion in the XZ plane matters.
+  out_point is the point on the box that is touched, at the sphere's height.
+*/
+bool sphereBoxTimeOfImpact(
+    const glm::vec3 & center, const glm::vec3 & velocity, float radius,
+    const Box & box, float maxTime, float & out_time, glm::vec3 & out_point);
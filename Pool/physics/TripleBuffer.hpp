@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+
+/*
+  Lock-free triple buffer handing values from one writer thread to one reader
+  thread. The writer fills in its buffer and publishes it; the reader picks
+  up the latest published buffer whenever it likes. Neither ever waits for
+  the other, and the reader always has a complete value to look at.
+
+  The third buffer sits between the two: publishing swaps it with the
+  writer's, and picking up swaps it with the reader's. A flag on it says
+  whether it holds a value the reader hasn't picked up yet.
+*/
+template <typename T>
+class TripleBuffer {
+  public:
+    TripleBuffer();
+
+    // Set every buffer to value; only before the writer and reader start
+    void reset(const T & value);
+
+    // Buffer the writer fills in next (writer only). It holds whatever was
+    // published two times ago, so it must be overwritten entirely.
+    T & getWriteBuffer();
+    // Make the write buffer the latest value (writer only)
+    void publish();
+
+    // Pick up the latest value if one was published since the last call;
+    // returns whether there was one (reader only)
+    bool update();
+    // Value picked up by the last update() (reader only)
+    const T & getReadBuffer() const;
+
+  protected:
+    static const unsigned int INDEX_MASK = 3;
+    static const unsigned int FRESH = 4;
+
+    T m_buffers[3];
+    // Index of the middle buffer, | FRESH if it hasn't been picked up
+    std::atomic<unsigned int> m_middle;
+    unsigned int m_write; // owned by the writer
+    unsigned int m_read;  // owned by the reader
+
+    TripleBuffer(const TripleBuffer &);
+    TripleBuffer & operator=(const TripleBuffer &);
+};
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+TripleBuffer<T>::TripleBuffer()
+  : m_middle(1), m_write(0), m_read(2)
+{}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+void TripleBuffer<T>::reset(const T & value) {
+  for (T & buffer : m_buffers) {
+    buffer = value;
+  }
+  m_middle.store(m_middle.load() & INDEX_MASK);
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+T & TripleBuffer<T>::getWriteBuffer() {
+  return m_buffers[m_write];
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+void TripleBuffer<T>::publish() {
+  // Release the written value to the reader, and acquire the buffer it last
+  // gave back
+  m_write = m_middle.exchange(m_write | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+bool TripleBuffer<T>::update() {
+  if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+    return false;
+  }
+  m_read = m_middle.exchange(m_read, std::memory_order_acq_rel) & INDEX_MASK;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+const T & TripleBuffer<T>::getReadBuffer() const {
+  return m_buffers[m_read];
+}
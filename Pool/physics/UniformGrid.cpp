@@ -0,0 +1,171 @@
+#include "UniformGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace glm;
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+UniformGrid::UniformGrid()
+  : m_cellSize(1.0f), m_numCellsX(0), m_numCellsZ(0)
+{}
+
+//----------------------------------------------------------------------------------------
+void UniformGrid::setBounds( const vec2 & minCorner, const vec2 & maxCorner,
+                             float cellSize)
+{
+  m_min = minCorner;
+  m_cellSize = cellSize;
+  m_numCellsX = std::max(1, int(ceil((maxCorner.x - minCorner.x) / cellSize)));
+  m_numCellsZ = std::max(1, int(ceil((maxCorner.y - minCorner.y) / cellSize)));
+
+  size_t numCells = m_numCellsX * m_numCellsZ;
+  m_cellStart.assign(numCells + 1, 0);
+  m_cushionStart.assign(numCells + 1, 0);
+  m_cellBalls.clear();
+  m_cellCushions.clear();
+  m_ballCells.clear();
+}
+
+//----------------------------------------------------------------------------------------
+void UniformGrid::insertCushions(const vector<Box> & cushions, float margin) {
+  size_t numCells = m_numCellsX * m_numCellsZ;
+  vector<vector<size_t>> cellCushions(numCells);
+
+  for (size_t i = 0; i < cushions.size(); i++) {
+    const Box & box = cushions[i];
+    int x0 = cellX(box.m_center.x - box.m_extents.x / 2.0f - margin);
+    int x1 = cellX(box.m_center.x + box.m_extents.x / 2.0f + margin);
+    int z0 = cellZ(box.m_center.z - box.m_extents.z / 2.0f - margin);
+    int z1 = cellZ(box.m_center.z + box.m_extents.z / 2.0f + margin);
+    for (int z = z0; z <= z1; z++) {
+      for (int x = x0; x <= x1; x++) {
+        cellCushions[cellIndex(x, z)].push_back(i);
+      }
+    }
+  }
+
+  // Flatten into m_cushionStart / m_cellCushions
+  m_cellCushions.clear();
+  for (size_t c = 0; c < numCells; c++) {
+    m_cushionStart[c] = m_cellCushions.size();
+    m_cellCushions.insert( m_cellCushions.end(), cellCushions[c].begin(),
+                           cellCushions[c].end());
+  }
+  m_cushionStart[numCells] = m_cellCushions.size();
+}
+
+//----------------------------------------------------------------------------------------
+void UniformGrid::insertBalls(const BallState & balls, float duration) {
+  size_t numCells = m_numCellsX * m_numCellsZ;
+
+  // Counting sort of the balls by cell; a ball is counted once in each of
+  // the cells its swept bounds cover
+  m_ballCells.resize(balls.size());
+  fill(m_cellStart.begin(), m_cellStart.end(), 0);
+  for (size_t i = 0; i < balls.size(); i++) {
+    vec3 start = balls.getCenter(i);
+    vec3 end = start + balls.getVelocity(i) * duration;
+    vec3 lo = glm::min(start, end) - vec3(balls.getRadius(i));
+    vec3 hi = glm::max(start, end) + vec3(balls.getRadius(i));
+
+    CellRange & range = m_ballCells[i];
+    range.x0 = cellX(lo.x);
+    range.x1 = cellX(hi.x);
+    range.z0 = cellZ(lo.z);
+    range.z1 = cellZ(hi.z);
+    for (int z = range.z0; z <= range.z1; z++) {
+      for (int x = range.x0; x <= range.x1; x++) {
+        m_cellStart[cellIndex(x, z) + 1]++;
+      }
+    }
+  }
+  for (size_t c = 0; c < numCells; c++) {
+    m_cellStart[c + 1] += m_cellStart[c];
+  }
+
+  m_cellBalls.resize(m_cellStart[numCells]);
+  m_nextSlot.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+  for (size_t i = 0; i < balls.size(); i++) {
+    const CellRange & range = m_ballCells[i];
+    for (int z = range.z0; z <= range.z1; z++) {
+      for (int x = range.x0; x <= range.x1; x++) {
+        m_cellBalls[m_nextSlot[cellIndex(x, z)]++] = i;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------
+void UniformGrid::findBallPairs(vector<pair<size_t, size_t>> & out) const {
+  size_t first = out.size();
+
+  for (size_t i = 0; i < m_ballCells.size(); i++) {
+    const CellRange & range = m_ballCells[i];
+    for (int z = range.z0; z <= range.z1; z++) {
+      for (int x = range.x0; x <= range.x1; x++) {
+        int cell = cellIndex(x, z);
+        for (size_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; k++) {
+          size_t j = m_cellBalls[k];
+          if (j > i) {
+            out.push_back(make_pair(i, j));
+          }
+        }
+      }
+    }
+  }
+
+  // Balls sharing several cells were paired once per cell
+  sort(out.begin() + first, out.end());
+  out.erase(unique(out.begin() + first, out.end()), out.end());
+}
+
+//----------------------------------------------------------------------------------------
+void UniformGrid::findCushions(size_t ball, vector<size_t> & out) const {
+  size_t first = out.size();
+
+  const CellRange & range = m_ballCells[ball];
+  for (int z = range.z0; z <= range.z1; z++) {
+    for (int x = range.x0; x <= range.x1; x++) {
+      int cell = cellIndex(x, z);
+      out.insert( out.end(), m_cellCushions.begin() + m_cushionStart[cell],
+                  m_cellCushions.begin() + m_cushionStart[cell + 1]);
+    }
+  }
+
+  sort(out.begin() + first, out.end());
+  out.erase(unique(out.begin() + first, out.end()), out.end());
+}
+
+//----------------------------------------------------------------------------------------
+bool UniformGrid::isEmpty() const {
+  return m_numCellsX == 0 || m_numCellsZ == 0;
+}
+
+//----------------------------------------------------------------------------------------
+int UniformGrid::cellX(float x) const {
+  return clampCell(floor((x - m_min.x) / m_cellSize), m_numCellsX);
+}
+
+//----------------------------------------------------------------------------------------
+int UniformGrid::cellZ(float z) const {
+  return clampCell(floor((z - m_min.y) / m_cellSize), m_numCellsZ);
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * Clamp before converting, since converting a NaN or out-of-range float to int
+ * is undefined, e.g. for a ball that escaped the table after a bad step.
+ */
+int UniformGrid::clampCell(float cell, int numCells) {
+  if (std::isnan(cell)) {
+    return 0;
+  }
+  return int(std::min(std::max(cell, 0.0f), float(numCells - 1)));
+}
+
+//----------------------------------------------------------------------------------------
+int UniformGrid::cellIndex(int x, int z) const {
+  return z * m_numCellsX + x;
+}
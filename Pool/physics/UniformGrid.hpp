@@ -0,0 +1,72 @@
+#pragma once
+
+#include "BallState.hpp"
+#include "Box.hpp"
+
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+/*
+  Broadphase for the table surface: a uniform grid of square cells over the
+  XZ plane. Each ball is binned into every cell overlapped by the bounds it
+  sweeps during a step, and only balls sharing a cell can collide, so finding
+  candidate pairs costs roughly O(n) instead of O(n^2).
+  Cells about one ball diameter wide work best.
+  Anything outside the bounds is clamped into the border cells.
+*/
+class UniformGrid {
+  public:
+    UniformGrid();
+
+    // Cover the XZ rectangle [minCorner, maxCorner] with cells of cellSize
+    void setBounds( const glm::vec2 & minCorner, const glm::vec2 & maxCorner,
+                    float cellSize);
+    /*
+      Record which cells each cushion may be touched from; a cushion is
+      registered in every cell its footprint, grown by margin, overlaps.
+      Cushions are static, so this only needs to be done once per setBounds.
+    */
+    void insertCushions(const std::vector<Box> & cushions, float margin);
+    /*
+      Bin the balls by the XZ bounds they sweep while moving along their
+      velocity for the given duration; replaces any previously inserted balls
+    */
+    void insertBalls(const BallState & balls, float duration);
+
+    // Append every pair (i, j), i < j, of balls sharing a cell, each once
+    void findBallPairs(std::vector<std::pair<size_t, size_t>> & out) const;
+    // Append the cushions sharing a cell with the given ball, each once
+    void findCushions(size_t ball, std::vector<size_t> & out) const;
+
+    bool isEmpty() const;
+
+  protected:
+    // Inclusive range of cells covered by a ball
+    struct CellRange {
+      int x0, z0, x1, z1;
+    };
+
+    int cellX(float x) const;
+    int cellZ(float z) const;
+    // Cell number in [0, numCells), for any cell coordinate, NaN included
+    static int clampCell(float cell, int numCells);
+    int cellIndex(int x, int z) const;
+
+    glm::vec2 m_min;
+    float m_cellSize;
+    int m_numCellsX;
+    int m_numCellsZ;
+
+    // Balls sorted by cell: the balls of cell c are
+    // m_cellBalls[m_cellStart[c] .. m_cellStart[c + 1])
+    std::vector<size_t> m_cellStart;
+    std::vector<size_t> m_cellBalls;
+    std::vector<CellRange> m_ballCells; // cells covered by each ball
+    std::vector<size_t> m_nextSlot; // scratch space for insertBalls
+
+    // Cushions of cell c are
+    // m_cellCushions[m_cushionStart[c] .. m_cushionStart[c + 1])
+    std::vector<size_t> m_cushionStart;
+    std::vector<size_t> m_cellCushions;
+};
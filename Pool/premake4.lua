@@ -16,8 +16,10 @@ libDirectories = {
 
 if os.get() == "macosx" then
     linkLibs = {
+        "pool-physics",
         "cs488-framework",
         "imgui",
+        "lodepng",
         "glfw3",
         "lua"
 
@@ -26,8 +28,10 @@ end
 
 if os.get() == "linux" then
     linkLibs = {
+        "pool-physics",
         "cs488-framework",
         "imgui",
+        "lodepng",
         "glfw3",
         "lua",
         "GL",
@@ -53,6 +57,18 @@ buildOptions = {"-std=c++11"}
 solution "CS488-Projects"
     configurations { "Debug", "Release" }
 
+    -- Builds the pool-physics static library: the ball and cushion simulation,
+    -- with no dependency on GLFW or OpenGL, so it can run headless.
+    project "pool-physics"
+        kind "StaticLib"
+        language "C++"
+        location "build"
+        objdir "build/pool-physics"
+        targetdir "../lib"
+        buildoptions (buildOptions)
+        includedirs (includeDirList)
+        files { "physics/*.cpp" }
+
     project "Pool"
         kind "ConsoleApp"
         language "C++"
@@ -66,6 +82,20 @@ solution "CS488-Projects"
         includedirs (includeDirList)
         files { "*.cpp" }
 
+    -- Times ObjFileDecoder against the decoder it replaced, and checks that
+    -- both agree; run ./ObjDecodeBench from this directory.
+    project "ObjDecodeBench"
+        kind "ConsoleApp"
+        language "C++"
+        location "build"
+        objdir "build/bench"
+        targetdir "."
+        buildoptions (buildOptions)
+        libdirs (libDirectories)
+        links { "cs488-framework", "stdc++", "pthread" }
+        includedirs (includeDirList)
+        files { "bench/*.cpp" }
+
     configuration "Debug"
         defines { "DEBUG" }
         flags { "Symbols" }
@@ -1,14 +1,14 @@
 #pragma once
 
 // Class for encapsulating index offset and number of indices to be rendered
-// for a batch of vertices.  It is assumed that there is a vertex buffer
-// setup so that all batch vertices are contiguous in memory and can be rendered
-// all at once given a start index offset into the vertex buffer, and a number
+// for a batch of vertices.  It is assumed that there is an index buffer
+// setup so that all batch indices are contiguous in memory and can be rendered
+// all at once given a start offset into the index buffer, and a number
 // of indices to be rendered.
 struct BatchInfo {
 
-	// Starting index within an associated vertex buffer denoting the start
-	// of this batch's vertex data.
+	// Starting index within an associated index buffer denoting the start
+	// of this batch's index data.
 	unsigned int startIndex;
 
 	// Number of indices to be rendered for this batch.
@@ -1,8 +1,11 @@
 #include "CS488Window.hpp"
 #include "cs488-framework/Exception.hpp"
 #include "cs488-framework/OpenGLImport.hpp"
+#include "cs488-framework/Profiler.hpp"
+#include "cs488-framework/TraceRecorder.hpp"
 
 #include <sstream>
+#include <cstring>
 #include <iostream>
 #include <thread>
 
@@ -19,6 +22,8 @@ static void renderImGui (int framebufferWidth, int framebufferHeight);
 
 //-- Static member initialization:
 string CS488Window::m_exec_dir = ".";
+string CS488Window::m_traceFilePath = "trace.json";
+bool CS488Window::m_dumpTraceOnExit = false;
 shared_ptr<CS488Window> CS488Window::m_instance = nullptr;
 
 
@@ -188,6 +193,10 @@ bool CS488Window::keyInputEvent (
 				glfwSwapBuffers(m_window);
 			}
 			eventHandled = true;
+
+		} else if (key == GLFW_KEY_F12) {
+			dumpTrace();
+			eventHandled = true;
 		}
 	}
 
@@ -302,17 +311,37 @@ void CS488Window::launch (
 		m_exec_dir = string( argv[0], slash );
 	}
 
+	// --trace <file>: dump the trace there on exit, and on F12
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp( argv[i], "--trace" ) == 0 && i + 1 < argc) {
+			m_traceFilePath = argv[++i];
+			m_dumpTraceOnExit = true;
+		}
+	}
+
 	if( m_instance == nullptr ) {
         m_instance = shared_ptr<CS488Window>(window);
 		m_instance->run( width, height, title, fps );
 	}
 }
 
+//----------------------------------------------------------------------------------------
+void CS488Window::dumpTrace() {
+	if (TraceRecorder::get().dump(m_traceFilePath)) {
+		cout << "Trace written to " << m_traceFilePath << endl;
+	} else {
+		cerr << "Unable to write trace to " << m_traceFilePath << endl;
+	}
+}
+
 //----------------------------------------------------------------------------------------
 static void renderImGui (
 		int framebufferWidth,
 		int framebufferHeight
 ) {
+	PROFILE_SCOPE("renderImGui");
+	PROFILE_GPU_SCOPE("ImGui");
+
 	// Set viewport to full window size.
 	glViewport(0, 0, framebufferWidth, framebufferHeight);
 	ImGui::Render();
@@ -325,6 +354,8 @@ void CS488Window::run (
 		const string &windowTitle,
 		float desiredFramesPerSecond
 ) {
+	TraceRecorder::get().setThreadName("main");
+
 	m_windowTitle = windowTitle;
     m_windowWidth = width;
     m_windowHeight = height;
@@ -387,24 +418,38 @@ void CS488Window::run (
         glfwSwapInterval(1);
 
 		// Call client-defined startup code.
-        init();
+        {
+            PROFILE_SCOPE("init");
+            init();
+        }
 
         // steady_clock::time_point frameStartTime;
 
         // Main Program Loop:
         while (!glfwWindowShouldClose(m_window)) {
+            Profiler::get().beginFrame();
+
             glfwPollEvents();
 			ImGui_ImplGlfwGL3_NewFrame();
 
             if (!m_paused) {
 				// Apply application-specific logic
-	            appLogic();
+				{
+					PROFILE_SCOPE("appLogic");
+					appLogic();
+				}
 
-	            guiLogic();
+				{
+					PROFILE_SCOPE("guiLogic");
+					guiLogic();
+				}
 
 				// Ask the derived class to do the actual OpenGL drawing.
-                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-                draw();
+				{
+					PROFILE_SCOPE("draw");
+					glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+					draw();
+				}
 
 	            // In case of a window resize, get new framebuffer dimensions.
 	            glfwGetFramebufferSize(m_window, &m_framebufferWidth,
@@ -414,9 +459,13 @@ void CS488Window::run (
 	            renderImGui(m_framebufferWidth, m_framebufferHeight);
 
 				// Finally, blast everything to the screen.
-                glfwSwapBuffers(m_window);
+				{
+					PROFILE_SCOPE("swapBuffers");
+					glfwSwapBuffers(m_window);
+				}
             }
 
+            Profiler::get().endFrame();
         }
         
     } catch (const  std::exception & e) {
@@ -427,7 +476,12 @@ void CS488Window::run (
     }
 
     cleanup();
+    Profiler::get().releaseGpuQueries();
     glfwDestroyWindow(m_window);
+
+    if (m_dumpTraceOnExit) {
+        dumpTrace();
+    }
 }
 
 
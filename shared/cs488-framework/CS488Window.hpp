@@ -30,6 +30,10 @@ protected:
 
 	static std::string getAssetFilePath(const char *base);
 
+	// Write the trace recorded so far as Chrome trace_event JSON, to the file
+	// given by --trace on the command line, or trace.json.
+	static void dumpTrace();
+
     // Virtual methods.
     // Override these within derived classes.
     virtual void init();
@@ -60,6 +64,9 @@ private:
 	static std::shared_ptr<CS488Window> m_instance;
 
 	static std::string m_exec_dir;
+
+	static std::string m_traceFilePath;
+	static bool m_dumpTraceOnExit; // --trace was given
     
     GLFWmonitor * m_monitor;
 
@@ -0,0 +1,78 @@
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------------------------
+MappedFile::MappedFile()
+	: m_data(nullptr),
+	  m_size(0),
+	  m_isOpen(false)
+{
+
+}
+
+//----------------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+//----------------------------------------------------------------------------------------
+bool MappedFile::open(const char * filePath) {
+	close();
+
+	int fd = ::open(filePath, O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		::close(fd);
+		return false;
+	}
+
+	// Empty files can't be mapped, but are still valid.
+	if (info.st_size > 0) {
+		void * data = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			::close(fd);
+			return false;
+		}
+		m_data = static_cast<const char *>(data);
+		m_size = size_t(info.st_size);
+	}
+
+	// The mapping stays valid after the descriptor is closed.
+	::close(fd);
+	m_isOpen = true;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------
+void MappedFile::close() {
+	if (m_data) {
+		munmap(const_cast<char *>(m_data), m_size);
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_isOpen = false;
+}
+
+//----------------------------------------------------------------------------------------
+bool MappedFile::isOpen() const {
+	return m_isOpen;
+}
+
+//----------------------------------------------------------------------------------------
+const char * MappedFile::data() const {
+	return m_data;
+}
+
+//----------------------------------------------------------------------------------------
+size_t MappedFile::size() const {
+	return m_size;
+}
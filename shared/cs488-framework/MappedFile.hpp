@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * Read-only memory mapping of a whole file, unmapped on destruction.
+ */
+class MappedFile {
+public:
+	MappedFile();
+
+	~MappedFile();
+
+	// Map the file at filePath, replacing any current mapping.
+	// Returns false if the file can't be opened or mapped.
+	bool open(const char * filePath);
+
+	void close();
+
+	bool isOpen() const;
+
+	const char * data() const;
+
+	size_t size() const;
+
+private:
+	MappedFile(const MappedFile &);
+	MappedFile & operator = (const MappedFile &);
+
+	const char * m_data;
+	size_t m_size;
+	bool m_isOpen;
+};
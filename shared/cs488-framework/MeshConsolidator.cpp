@@ -5,9 +5,43 @@ using namespace std;
 #include "cs488-framework/Exception.hpp"
 #include "cs488-framework/ObjFileDecoder.hpp"
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include <sys/stat.h>
+
+// Bump whenever the layout of the cache changes.
+static const uint32_t MESH_CACHE_MAGIC = 0x4853454d; // "MESH"
+static const uint32_t MESH_CACHE_VERSION = 1;
+
+struct MeshCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceKey;
+	uint32_t vertexSize;
+	uint32_t indexSize;
+	uint32_t numBatches;
+	uint32_t numVertices;
+	uint32_t numIndices;
+	uint32_t padding;
+};
+
+struct MeshCacheBatch {
+	char meshId[56]; // NUL-terminated
+	uint32_t startIndex;
+	uint32_t numIndices;
+};
+
 //----------------------------------------------------------------------------------------
 // Default constructor
 MeshConsolidator::MeshConsolidator()
+	: m_vertices(nullptr),
+	  m_numVertices(0),
+	  m_indices(nullptr),
+	  m_numIndices(0),
+	  m_indexSize(sizeof(unsigned short))
 {
 
 }
@@ -20,21 +54,217 @@ MeshConsolidator::~MeshConsolidator()
 }
 
 //----------------------------------------------------------------------------------------
-template <typename T>
-static void appendVector (
-		std::vector<T> & dest,
-		const std::vector<T> & source
+// Vertices are compared bit for bit, so only exact duplicates are merged.
+static_assert(sizeof(Vertex) == 8 * sizeof(float),
+		"Vertex must have no padding for its bytes to be hashed and compared");
+
+struct VertexHash {
+	size_t operator () (const Vertex & vertex) const {
+		const unsigned char * bytes = reinterpret_cast<const unsigned char *>(&vertex);
+
+		// FNV-1a
+		size_t hash = 2166136261u;
+		for (size_t i = 0; i < sizeof(Vertex); ++i) {
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+		return hash;
+	}
+};
+
+struct VertexEqual {
+	bool operator () (const Vertex & a, const Vertex & b) const {
+		return memcmp(&a, &b, sizeof(Vertex)) == 0;
+	}
+};
+
+
+//----------------------------------------------------------------------------------------
+/*
+ * Hash of the path, size and modification time of each .obj file, and of the
+ * Vertex layout.  Returns false if a file can't be found.
+ */
+static bool computeSourceKey(
+		const std::vector<ObjFilePath> & objFileList,
+		uint64_t & sourceKey
 ) {
-	// Increase capacity to hold source.size() more elements
-	dest.reserve(dest.size() + source.size());
+	// FNV-1a
+	sourceKey = 14695981039346656037ull;
+	auto hashBytes = [&sourceKey] (const void * data, size_t size) {
+		const unsigned char * bytes = static_cast<const unsigned char *>(data);
+		for (size_t i = 0; i < size; ++i) {
+			sourceKey = (sourceKey ^ bytes[i]) * 1099511628211ull;
+		}
+	};
 
-	dest.insert(dest.end(), source.begin(), source.end());
-}
+	uint64_t vertexSize = sizeof(Vertex);
+	hashBytes(&vertexSize, sizeof(vertexSize));
 
+	for(const ObjFilePath & objFile : objFileList) {
+		struct stat info;
+		if (stat(objFile.c_str(), &info) != 0) {
+			return false;
+		}
+		int64_t modificationTime = info.st_mtime;
+		int64_t fileSize = info.st_size;
+		hashBytes(objFile.c_str(), objFile.size() + 1);
+		hashBytes(&modificationTime, sizeof(modificationTime));
+		hashBytes(&fileSize, sizeof(fileSize));
+	}
+	return true;
+}
 
 //----------------------------------------------------------------------------------------
 MeshConsolidator::MeshConsolidator(
 		std::initializer_list<ObjFilePath> objFileList
+)
+	: MeshConsolidator()
+{
+	consolidate(objFileList);
+}
+
+//----------------------------------------------------------------------------------------
+MeshConsolidator::MeshConsolidator(
+		std::initializer_list<ObjFilePath> objFileList,
+		const std::string & cacheFilePath
+)
+	: MeshConsolidator()
+{
+	vector<ObjFilePath> objFiles(objFileList);
+
+	uint64_t sourceKey;
+	if (! computeSourceKey(objFiles, sourceKey)) {
+		// Let the decoder report the missing file.
+		consolidate(objFiles);
+		return;
+	}
+
+	if (readCache(cacheFilePath, sourceKey)) {
+		return;
+	}
+
+	consolidate(objFiles);
+	writeCache(cacheFilePath, sourceKey);
+}
+
+//----------------------------------------------------------------------------------------
+bool MeshConsolidator::readCache(
+		const std::string & cacheFilePath,
+		uint64_t sourceKey
+) {
+	if (! m_cache.open(cacheFilePath.c_str())) {
+		return false;
+	}
+
+	const char * data = m_cache.data();
+	size_t size = m_cache.size();
+
+	MeshCacheHeader header;
+	if (size < sizeof(header)) {
+		m_cache.close();
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	size_t batchTableBytes = size_t(header.numBatches) * sizeof(MeshCacheBatch);
+	size_t vertexBytes = size_t(header.numVertices) * sizeof(Vertex);
+	size_t indexBytes = size_t(header.numIndices) * header.indexSize;
+	if ( header.magic != MESH_CACHE_MAGIC ||
+	     header.version != MESH_CACHE_VERSION ||
+	     header.sourceKey != sourceKey ||
+	     header.vertexSize != sizeof(Vertex) ||
+	     (header.indexSize != sizeof(unsigned short) &&
+	      header.indexSize != sizeof(unsigned int)) ||
+	     size != sizeof(header) + batchTableBytes + vertexBytes + indexBytes )
+	{
+		// Stale or from another version; rebuild it.
+		m_cache.close();
+		return false;
+	}
+
+	const char * batchTable = data + sizeof(header);
+	for (uint32_t i = 0; i < header.numBatches; ++i) {
+		MeshCacheBatch batch;
+		memcpy(&batch, batchTable + i * sizeof(MeshCacheBatch), sizeof(batch));
+		if ( memchr(batch.meshId, '\0', sizeof(batch.meshId)) == nullptr ||
+		     batch.startIndex > header.numIndices ||
+		     batch.numIndices > header.numIndices - batch.startIndex )
+		{
+			m_cache.close();
+			m_batchInfoMap.clear();
+			return false;
+		}
+
+		BatchInfo batchInfo;
+		batchInfo.startIndex = batch.startIndex;
+		batchInfo.numIndices = batch.numIndices;
+		m_batchInfoMap[batch.meshId] = batchInfo;
+	}
+
+	m_vertices = reinterpret_cast<const Vertex *>(batchTable + batchTableBytes);
+	m_numVertices = header.numVertices;
+	m_indices = batchTable + batchTableBytes + vertexBytes;
+	m_numIndices = header.numIndices;
+	m_indexSize = header.indexSize;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * Written to a temporary file that is then renamed over the cache, so that a
+ * half-written cache is never read.
+ */
+void MeshConsolidator::writeCache(
+		const std::string & cacheFilePath,
+		uint64_t sourceKey
+) const {
+	MeshCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	header.sourceKey = sourceKey;
+	header.vertexSize = sizeof(Vertex);
+	header.indexSize = uint32_t(m_indexSize);
+	header.numBatches = uint32_t(m_batchInfoMap.size());
+	header.numVertices = uint32_t(m_numVertices);
+	header.numIndices = uint32_t(m_numIndices);
+
+	vector<MeshCacheBatch> batchTable;
+	for (const auto & entry : m_batchInfoMap) {
+		MeshCacheBatch batch;
+		memset(&batch, 0, sizeof(batch));
+		if (entry.first.size() >= sizeof(batch.meshId)) {
+			return; // can't be cached
+		}
+		entry.first.copy(batch.meshId, entry.first.size());
+		batch.startIndex = entry.second.startIndex;
+		batch.numIndices = entry.second.numIndices;
+		batchTable.push_back(batch);
+	}
+
+	string tempFilePath = cacheFilePath + ".tmp";
+	{
+		ofstream out(tempFilePath.c_str(), ios::out | ios::binary | ios::trunc);
+		out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char *>(batchTable.data()),
+				batchTable.size() * sizeof(MeshCacheBatch));
+		out.write(reinterpret_cast<const char *>(m_vertices),
+				m_numVertices * sizeof(Vertex));
+		out.write(static_cast<const char *>(m_indices), m_numIndices * m_indexSize);
+		if (! out) {
+			out.close();
+			remove(tempFilePath.c_str());
+			return;
+		}
+	}
+
+	if (rename(tempFilePath.c_str(), cacheFilePath.c_str()) != 0) {
+		remove(tempFilePath.c_str());
+	}
+}
+
+//----------------------------------------------------------------------------------------
+void MeshConsolidator::consolidate(
+		const std::vector<ObjFilePath> & objFileList
 ) {
 
 	MeshId meshId;
@@ -42,7 +272,7 @@ MeshConsolidator::MeshConsolidator(
 	vector<vec3> normals;
 	vector<vec2> uvCoords;
 	BatchInfo batchInfo;
-	unsigned long indexOffset(0);
+	unordered_map<Vertex, unsigned int, VertexHash, VertexEqual> vertexIndices;
 
     for(const ObjFilePath & objFile : objFileList) {
 	    ObjFileDecoder::decode(objFile.c_str(), meshId, positions, normals,
@@ -60,17 +290,48 @@ MeshConsolidator::MeshConsolidator(
 					"Number of UV coords inconsistent with number of positions\n");
 	    }
 
-	    batchInfo.startIndex = indexOffset;
+	    batchInfo.startIndex = m_indexData.size();
 	    batchInfo.numIndices = numIndices;
 
 	    m_batchInfoMap[meshId] = batchInfo;
 
-	    appendVector(m_vertexPositionData, positions);
-	    appendVector(m_vertexNormalData, normals);
-	    appendVector(m_vertexTextureData, uvCoords);
+	    // Deduplicate within each mesh; meshes don't share vertices.
+	    vertexIndices.clear();
+	    m_indexData.reserve(m_indexData.size() + numIndices);
+	    for (uint i = 0; i < numIndices; ++i) {
+		    Vertex vertex = { positions[i], normals[i], uvCoords[i] };
 
-	    indexOffset += numIndices;
+		    auto inserted = vertexIndices.insert(
+				    make_pair(vertex, (unsigned int)m_vertexData.size()));
+		    if (inserted.second) {
+			    m_vertexData.push_back(vertex);
+		    }
+		    m_indexData.push_back(inserted.first->second);
+	    }
     }
+
+	// Halve the index buffer when 16-bit indices can address every vertex.
+	if (m_vertexData.size() <= numeric_limits<unsigned short>::max() + size_t(1)) {
+		m_shortIndexData.assign(m_indexData.begin(), m_indexData.end());
+		vector<unsigned int>().swap(m_indexData);
+	}
+
+	m_vertices = m_vertexData.data();
+	m_numVertices = m_vertexData.size();
+	if (m_indexData.empty()) {
+		m_indices = m_shortIndexData.data();
+		m_numIndices = m_shortIndexData.size();
+		m_indexSize = sizeof(unsigned short);
+	} else {
+		m_indices = m_indexData.data();
+		m_numIndices = m_indexData.size();
+		m_indexSize = sizeof(unsigned int);
+	}
+}
+
+//----------------------------------------------------------------------------------------
+bool MeshConsolidator::isFromCache() const {
+	return m_cache.isOpen();
 }
 
 //----------------------------------------------------------------------------------------
@@ -81,37 +342,38 @@ void MeshConsolidator::getBatchInfoMap (
 }
 
 //----------------------------------------------------------------------------------------
-// Returns the starting memory location for vertex position data.
-const float * MeshConsolidator::getVertexPositionDataPtr() const {
-	return &(m_vertexPositionData[0].x);
+// Returns the starting memory location for interleaved vertex data.
+const Vertex * MeshConsolidator::getVertexDataPtr() const {
+	return m_vertices;
 }
 
 //----------------------------------------------------------------------------------------
-// Returns the starting memory location for vertex normal data.
-const float * MeshConsolidator::getVertexNormalDataPtr() const {
-    return &(m_vertexNormalData[0].x);
+// Returns the total number of bytes of all vertex data.
+size_t MeshConsolidator::getNumVertexBytes() const {
+	return m_numVertices * sizeof(Vertex);
 }
 
 //----------------------------------------------------------------------------------------
-// Returns the starting memory location for vertex texture data.
-const float * MeshConsolidator::getVertexTextureDataPtr() const {
-    return &(m_vertexTextureData[0].x);
+// Returns the starting memory location for index data.
+const void * MeshConsolidator::getIndexDataPtr() const {
+	return m_indices;
 }
 
 //----------------------------------------------------------------------------------------
-// Returns the total number of bytes of all vertex position data.
-size_t MeshConsolidator::getNumVertexPositionBytes() const {
-	return m_vertexPositionData.size() * sizeof(vec3);
+// Returns the total number of bytes of all index data.
+size_t MeshConsolidator::getNumIndexBytes() const {
+	return m_numIndices * m_indexSize;
 }
 
 //----------------------------------------------------------------------------------------
-// Returns the total number of bytes of all vertex normal data.
-size_t MeshConsolidator::getNumVertexNormalBytes() const {
-	return m_vertexNormalData.size() * sizeof(vec3);
+size_t MeshConsolidator::getIndexSize() const {
+	return m_indexSize;
 }
 
 //----------------------------------------------------------------------------------------
-// Returns the total number of bytes of all vertex texture data.
-size_t MeshConsolidator::getNumVertexTextureBytes() const {
-	return m_vertexTextureData.size() * sizeof(vec2);
+unsigned int MeshConsolidator::getIndex(size_t i) const {
+	if (m_indexSize == sizeof(unsigned short)) {
+		return static_cast<const unsigned short *>(m_indices)[i];
+	}
+	return static_cast<const unsigned int *>(m_indices)[i];
 }
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "cs488-framework/BatchInfo.hpp"
+#include "cs488-framework/MappedFile.hpp"
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <initializer_list>
 #include <vector>
 #include <unordered_map>
@@ -24,8 +26,26 @@ typedef std::string ObjFilePath;
 typedef std::unordered_map<MeshId, BatchInfo>  BatchInfoMap;
 
 
+// Interleaved vertex attributes, as stored in the consolidated vertex buffer.
+struct Vertex {
+	glm::vec3 position;
+	glm::vec3 normal;
+	glm::vec2 uv;
+};
+
+
 /*
 * Class for consolidating all vertex data within a list of .obj files.
+*
+* Vertices shared by several triangles of a mesh are stored once, in a single
+* interleaved Vertex array, and the triangles are given by an index buffer.
+* Indices are 16-bit when every vertex can be addressed with them, and 32-bit
+* otherwise; getIndexSize() tells which.
+*
+* The consolidated data can be cached in a binary file: a header, a table of
+* BatchInfos, then the vertex and index data exactly as they are uploaded to
+* the GPU.  The cache is keyed by the path, size and modification time of every
+* .obj file, so it is rebuilt whenever one of them changes.
 */
 class MeshConsolidator {
 public:
@@ -33,27 +53,60 @@ public:
 
 	MeshConsolidator(std::initializer_list<ObjFilePath>  objFileList);
 
+	// Memory-maps the cache at cacheFilePath and uses its data in place if it is
+	// up to date with objFileList.  Otherwise decodes the .obj files and writes
+	// the cache for next time; failing to write it is not an error.
+	MeshConsolidator(std::initializer_list<ObjFilePath>  objFileList,
+			const std::string & cacheFilePath);
+
 	~MeshConsolidator();
 
-	const float * getVertexPositionDataPtr() const;
+	// Whether the data was read from the cache rather than decoded.
+	bool isFromCache() const;
 
-	const float * getVertexNormalDataPtr() const;
+	const Vertex * getVertexDataPtr() const;
 
-  const float * getVertexTextureDataPtr() const;
+	size_t getNumVertexBytes() const;
 
-	size_t getNumVertexPositionBytes() const;
+	const void * getIndexDataPtr() const;
 
-	size_t getNumVertexNormalBytes() const;
-	
-	size_t getNumVertexTextureBytes() const;
+	size_t getNumIndexBytes() const;
+
+	// Size in bytes of one index: 2 or 4.
+	size_t getIndexSize() const;
+
+	// The i-th index, whatever its size.
+	unsigned int getIndex(size_t i) const;
 
 	void getBatchInfoMap(BatchInfoMap & batchInfoMap) const;
 
 
 private:
-	std::vector<glm::vec3> m_vertexPositionData;
-	std::vector<glm::vec3> m_vertexNormalData;
-	std::vector<glm::vec2> m_vertexTextureData;
+	MeshConsolidator(const MeshConsolidator &);
+	MeshConsolidator & operator = (const MeshConsolidator &);
+
+	void consolidate(const std::vector<ObjFilePath> & objFileList);
+
+	bool readCache(const std::string & cacheFilePath, uint64_t sourceKey);
+
+	void writeCache(const std::string & cacheFilePath, uint64_t sourceKey) const;
+
+	std::vector<Vertex> m_vertexData;
+
+	// Only one of these is filled in, depending on the number of vertices.
+	std::vector<unsigned short> m_shortIndexData;
+	std::vector<unsigned int> m_indexData;
+
+	// When read from the cache, the data is used where it is mapped and the
+	// vectors above stay empty.
+	MappedFile m_cache;
+
+	// The data to hand out, wherever it lives.
+	const Vertex * m_vertices;
+	size_t m_numVertices;
+	const void * m_indices;
+	size_t m_numIndices;
+	size_t m_indexSize;
 
 	BatchInfoMap m_batchInfoMap;
 };
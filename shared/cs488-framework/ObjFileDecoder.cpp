@@ -1,16 +1,214 @@
 #include "ObjFileDecoder.hpp"
 using namespace glm;
 
-#include <fstream>
-#include <sstream>
-#include <iostream>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
+#include <sstream>
 using namespace std;
 
 #include "cs488-framework/Exception.hpp"
+#include "cs488-framework/MappedFile.hpp"
+#include "cs488-framework/TraceRecorder.hpp"
 
 
+namespace {
+
 //---------------------------------------------------------------------------------------
+/*
+ * Single pass cursor over the .obj text.  Every read stops at the end of the
+ * current line, so a malformed line can't run into the next one.
+ */
+class ObjParser {
+public:
+	ObjParser(const char * filePath, const char * begin, const char * end)
+		: m_filePath(filePath), m_pos(begin), m_end(end), m_lineNumber(1) { }
+
+	bool atEnd() const { return m_pos == m_end; }
+
+	bool atEndOfLine() const {
+		return m_pos == m_end || *m_pos == '\n' || *m_pos == '#';
+	}
+
+	void skipSpaces() {
+		while (m_pos != m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r')) {
+			++m_pos;
+		}
+	}
+
+	// Skip the rest of the line, including any comment, and its newline.
+	void nextLine() {
+		const char * newline = static_cast<const char *>(memchr(m_pos, '\n', m_end - m_pos));
+		m_pos = newline ? newline + 1 : m_end;
+		++m_lineNumber;
+	}
+
+	// Read the next whitespace-delimited token of the line; may be empty.
+	void token(const char * & out_begin, const char * & out_end) {
+		skipSpaces();
+		out_begin = m_pos;
+		while (m_pos != m_end && ! isSpace(*m_pos)) {
+			++m_pos;
+		}
+		out_end = m_pos;
+	}
+
+	/*
+	 * Gives the same float as strtof.  The digits are gathered into an integer
+	 * mantissa; when it and the power of ten scaling it are exact doubles, one
+	 * correctly rounded division or multiplication, then rounding to float,
+	 * rounds as strtof does (double has more than twice float's precision, so
+	 * rounding twice can't go astray).  Anything else goes to strtof itself.
+	 */
+	float parseFloat() {
+		skipSpaces();
+		const char * start = m_pos;
+
+		bool isNegative = false;
+		if (m_pos != m_end && (*m_pos == '-' || *m_pos == '+')) {
+			isNegative = *m_pos == '-';
+			++m_pos;
+		}
+
+		// Up to 19 significant digits fit in the mantissa; the rest only
+		// shift the exponent.
+		unsigned long long mantissa = 0;
+		int numDigits = 0;
+		long exponent = 0;
+		bool hasDigits = false;
+		while (m_pos != m_end && isDigit(*m_pos)) {
+			if (numDigits < 19) {
+				mantissa = mantissa * 10 + (*m_pos - '0');
+				if (mantissa != 0) ++numDigits;
+			} else {
+				++exponent;
+			}
+			hasDigits = true;
+			++m_pos;
+		}
+		if (m_pos != m_end && *m_pos == '.') {
+			++m_pos;
+			while (m_pos != m_end && isDigit(*m_pos)) {
+				if (numDigits < 19) {
+					mantissa = mantissa * 10 + (*m_pos - '0');
+					if (mantissa != 0) ++numDigits;
+					--exponent;
+				}
+				hasDigits = true;
+				++m_pos;
+			}
+		}
+		if (! hasDigits) {
+			m_pos = start;
+			error("expected a number");
+		}
+		if (m_pos != m_end && (*m_pos == 'e' || *m_pos == 'E')) {
+			++m_pos;
+			exponent += parseInt();
+		}
+
+		// 15 digits always fit in the 53 bits of a double's mantissa, and
+		// 10^22 is the largest exact power of ten
+		if (numDigits > 15 || exponent < -22 || exponent > 22) {
+			string text(start, m_pos);
+			return strtof(text.c_str(), nullptr);
+		}
+
+		double value = double(mantissa);
+		if (exponent < 0) {
+			value /= POWERS_OF_TEN[-exponent];
+		} else if (exponent > 0) {
+			value *= POWERS_OF_TEN[exponent];
+		}
+		return float(isNegative ? -value : value);
+	}
+
+	// Values past INT_MAX saturate, so they still read as out of range.
+	int parseInt() {
+		bool isNegative = false;
+		if (m_pos != m_end && (*m_pos == '-' || *m_pos == '+')) {
+			isNegative = *m_pos == '-';
+			++m_pos;
+		}
+		if (m_pos == m_end || ! isDigit(*m_pos)) {
+			error("expected an integer");
+		}
+		int value = 0;
+		while (m_pos != m_end && isDigit(*m_pos)) {
+			int digit = *m_pos - '0';
+			value = value > (INT_MAX - digit) / 10 ? INT_MAX : value * 10 + digit;
+			++m_pos;
+		}
+		return isNegative ? -value : value;
+	}
+
+	// Consume c if it is the next character.
+	bool accept(char c) {
+		if (m_pos != m_end && *m_pos == c) {
+			++m_pos;
+			return true;
+		}
+		return false;
+	}
+
+	/*
+	 * Turn a 1-based, or negative (relative to the end), .obj index into a
+	 * 0-based index into an array of the given size.
+	 */
+	size_t resolveIndex(int index, size_t size) const {
+		long resolved = index > 0 ? long(index) - 1 : long(size) + index;
+		if (index == 0 || resolved < 0 || size_t(resolved) >= size) {
+			error("face index out of range");
+		}
+		return size_t(resolved);
+	}
+
+	void error(const char * what) const {
+		stringstream errorMessage;
+		errorMessage << "Error parsing .obj file " << m_filePath << ", line "
+			<< m_lineNumber << ": " << what << endl;
+		throw Exception(errorMessage.str());
+	}
+
+private:
+	static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+	static bool isSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	static const double POWERS_OF_TEN[23];
+
+	const char * m_filePath;
+	const char * m_pos;
+	const char * m_end;
+	size_t m_lineNumber;
+};
+
+const double ObjParser::POWERS_OF_TEN[23] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// One corner of a face: indices into the position, uv and normal arrays.
+struct FaceVertex {
+	size_t position;
+	size_t uvCoord;
+	size_t normal;
+	bool hasUvCoord;
+	bool hasNormal;
+};
+
+} // namespace
+
+
+//---------------------------------------------------------------------------------------
+/*
+ * Faces may be triangles or larger polygons, which are split into a fan of
+ * triangles.  Each corner is "v", "v/vt", "v//vn" or "v/vt/vn"; corners without
+ * a texture coordinate get (0, 0), and corners without a normal get the normal
+ * of their triangle.
+ */
 void ObjFileDecoder::decode(
 		const char * objFilePath,
 		std::string & objectName,
@@ -18,142 +216,132 @@ void ObjFileDecoder::decode(
         std::vector<vec3> & normals,
         std::vector<vec2> & uvCoords
 ) {
+	TRACE_SCOPE("decodeObj");
 
 	// Empty containers, and start fresh before inserting data from .obj file
 	positions.clear();
 	normals.clear();
 	uvCoords.clear();
 
-    ifstream in(objFilePath, std::ios::in);
-    in.exceptions(std::ifstream::badbit);
+	MappedFile file;
+	if (! file.open(objFilePath)) {
+		stringstream errorMessage;
+		errorMessage << "Unable to open .obj file " << objFilePath
+			<< " within method ObjFileDecoder::decode" << endl;
+		throw Exception(errorMessage.str());
+	}
+	ObjParser parser(objFilePath, file.data(), file.data() + file.size());
 
-    if (!in) {
-        stringstream errorMessage;
-        errorMessage << "Unable to open .obj file " << objFilePath
-            << " within method ObjFileDecoder::decode" << endl;
+	vector<vec3> temp_positions;
+	vector<vec3> temp_normals;
+	vector<vec2> temp_uvCoords;
+	vector<FaceVertex> face;
 
-        throw Exception(errorMessage.str().c_str());
-    }
+	objectName = "";
 
-    string currentLine;
-    int positionIndexA, positionIndexB, positionIndexC;
-    int normalIndexA, normalIndexB, normalIndexC;
-    int uvCoordIndexA, uvCoordIndexB, uvCoordIndexC;
-    vector<vec3> temp_positions;
-    vector<vec3> temp_normals;
-    vector<vec2> temp_uvCoords;
+	while (! parser.atEnd()) {
+		const char * keyword;
+		const char * keywordEnd;
+		parser.token(keyword, keywordEnd);
+		size_t keywordLength = keywordEnd - keyword;
 
-	objectName = "";
+		if (keywordLength == 1 && keyword[0] == 'o') {
+			const char * name;
+			const char * nameEnd;
+			parser.token(name, nameEnd);
+			objectName.assign(name, nameEnd);
+
+		} else if (keywordLength == 1 && keyword[0] == 'v') {
+			vec3 vertex;
+			vertex.x = parser.parseFloat();
+			vertex.y = parser.parseFloat();
+			vertex.z = parser.parseFloat();
+			temp_positions.push_back(vertex);
+
+		} else if (keywordLength == 2 && keyword[0] == 'v' && keyword[1] == 'n') {
+			vec3 normal;
+			normal.x = parser.parseFloat();
+			normal.y = parser.parseFloat();
+			normal.z = parser.parseFloat();
+			temp_normals.push_back(normal);
+
+		} else if (keywordLength == 2 && keyword[0] == 'v' && keyword[1] == 't') {
+			vec2 textureCoord;
+			textureCoord.s = parser.parseFloat();
+			textureCoord.t = parser.parseFloat();
+			temp_uvCoords.push_back(textureCoord);
+
+		} else if (keywordLength == 1 && keyword[0] == 'f') {
+			face.clear();
+			parser.skipSpaces();
+			while (! parser.atEndOfLine()) {
+				FaceVertex corner;
+				corner.position = parser.resolveIndex(parser.parseInt(),
+						temp_positions.size());
+				corner.hasUvCoord = false;
+				corner.hasNormal = false;
+
+				if (parser.accept('/')) {
+					if (! parser.accept('/')) {
+						// "v/vt" or "v/vt/vn"
+						corner.uvCoord = parser.resolveIndex(parser.parseInt(),
+								temp_uvCoords.size());
+						corner.hasUvCoord = true;
+						if (parser.accept('/')) {
+							corner.normal = parser.resolveIndex(parser.parseInt(),
+									temp_normals.size());
+							corner.hasNormal = true;
+						}
+					} else {
+						// "v//vn"
+						corner.normal = parser.resolveIndex(parser.parseInt(),
+								temp_normals.size());
+						corner.hasNormal = true;
+					}
+				}
 
-    while (!in.eof()) {
-        try {
-            getline(in, currentLine);
-        } catch (const ifstream::failure &e) {
-            in.close();
-            stringstream errorMessage;
-            errorMessage << "Error calling getline() -- " << e.what() << endl;
-            throw Exception(errorMessage.str());
-        }
-	    if (currentLine.substr(0, 2) == "o ") {
-		    // Get entire line excluding first 2 chars.
-		    istringstream s(currentLine.substr(2));
-		    s >> objectName;
-
-
-	    } else if (currentLine.substr(0, 2) == "v ") {
-            // Vertex data on this line.
-            // Get entire line excluding first 2 chars.
-            istringstream s(currentLine.substr(2));
-            glm::vec3 vertex;
-            s >> vertex.x;
-            s >> vertex.y;
-            s >> vertex.z;
-            temp_positions.push_back(vertex);
-
-        } else if (currentLine.substr(0, 3) == "vn ") {
-            // Normal data on this line.
-            // Get entire line excluding first 2 chars.
-            istringstream s(currentLine.substr(2));
-            vec3 normal;
-            s >> normal.x;
-            s >> normal.y;
-            s >> normal.z;
-            temp_normals.push_back(normal);
-
-        } else if (currentLine.substr(0, 3) == "vt ") {
-            // Texture coordinate data on this line.
-            // Get entire line excluding first 2 chars.
-            istringstream s(currentLine.substr(2));
-            vec2 textureCoord;
-            s >> textureCoord.s;
-            s >> textureCoord.t;
-            temp_uvCoords.push_back(textureCoord);
-
-        } else if (currentLine.substr(0, 2) == "f ") {
-            // Face index data on this line.
-
-            int index;
-
-            // sscanf will return the number of matched index values it found
-            // from the pattern.
-            int numberOfIndexMatches = sscanf(currentLine.c_str(), "f %d/%d/%d",
-                                              &index, &index, &index);
-
-            if (numberOfIndexMatches == 3) {
-                // Line contains indices of the pattern vertex/uv-cord/normal.
-                sscanf(currentLine.c_str(), "f %d/%d/%d %d/%d/%d %d/%d/%d",
-                       &positionIndexA, &uvCoordIndexA, &normalIndexA,
-                       &positionIndexB, &uvCoordIndexB, &normalIndexB,
-                       &positionIndexC, &uvCoordIndexC, &normalIndexC);
-
-                // .obj file uses indices that start at 1, so subtract 1 so they start at 0.
-                uvCoordIndexA--;
-                uvCoordIndexB--;
-                uvCoordIndexC--;
-
-                uvCoords.push_back(temp_uvCoords[uvCoordIndexA]);
-                uvCoords.push_back(temp_uvCoords[uvCoordIndexB]);
-                uvCoords.push_back(temp_uvCoords[uvCoordIndexC]);
-
-            } else {
-                // Line contains indices of the pattern vertex//normal.
-                sscanf(currentLine.c_str(), "f %d//%d %d//%d %d//%d",
-		               &positionIndexA, &normalIndexA,
-                       &positionIndexB, &normalIndexB,
-                       &positionIndexC, &normalIndexC);
-                
-                vec2 tmp;
-                uvCoords.push_back(tmp);
-                uvCoords.push_back(tmp);
-                uvCoords.push_back(tmp);
-            }
-
-            positionIndexA--;
-            positionIndexB--;
-            positionIndexC--;
-            normalIndexA--;
-            normalIndexB--;
-            normalIndexC--;
-
-            positions.push_back(temp_positions[positionIndexA]);
-            positions.push_back(temp_positions[positionIndexB]);
-            positions.push_back(temp_positions[positionIndexC]);
-
-            normals.push_back(temp_normals[normalIndexA]);
-            normals.push_back(temp_normals[normalIndexB]);
-            normals.push_back(temp_normals[normalIndexC]);
-        }
-    }
-
-    in.close();
+				face.push_back(corner);
+				parser.skipSpaces();
+			}
+
+			if (face.size() < 3) {
+				parser.error("face with fewer than 3 vertices");
+			}
+
+			// Triangle fan around the first corner
+			for (size_t i = 1; i + 1 < face.size(); ++i) {
+				const FaceVertex * triangle[3] = { &face[0], &face[i], &face[i + 1] };
+
+				vec3 a = temp_positions[triangle[0]->position];
+				vec3 b = temp_positions[triangle[1]->position];
+				vec3 c = temp_positions[triangle[2]->position];
+				vec3 faceNormal = cross(b - a, c - a);
+				if (faceNormal != vec3(0.0f)) {
+					faceNormal = normalize(faceNormal);
+				}
+
+				for (const FaceVertex * corner : triangle) {
+					positions.push_back(temp_positions[corner->position]);
+					normals.push_back(corner->hasNormal ?
+							temp_normals[corner->normal] : faceNormal);
+					uvCoords.push_back(corner->hasUvCoord ?
+							temp_uvCoords[corner->uvCoord] : vec2());
+				}
+			}
+		}
+
+		parser.nextLine();
+	}
 
 	if (objectName.compare("") == 0) {
 		// No 'o' object name tag defined in .obj file, so use the file name
 		// minus the '.obj' ending as the objectName.
 		const char * ptr = strrchr(objFilePath, '/');
-		objectName.assign(ptr+1);
+		objectName.assign(ptr ? ptr+1 : objFilePath);
 		size_t pos = objectName.find('.');
-		objectName.resize(pos);
+		if (pos != string::npos) {
+			objectName.resize(pos);
+		}
 	}
 }
 
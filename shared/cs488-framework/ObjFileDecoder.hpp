@@ -11,6 +11,11 @@ public:
 	* Extracts vertex data from a Wavefront .obj file
 	* If an object name parameter is present in the .obj file, objectName is set to that,
 	* otherwise objectName is set to the name of the .obj file.
+	* Polygons are split into triangles, and three entries are output per triangle.
+	* Face indices may be negative (relative to the last vertex read), and texture
+	* coordinates and normals may be missing: uvCoords are then (0,0), and normals
+	* the normal of the triangle.
+	* Throws an Exception naming the line if the file is malformed.
 	*
 	* [in] objFilePath - path to .obj file
 	* [out] objectName - name given to object.
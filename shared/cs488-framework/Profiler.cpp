@@ -0,0 +1,209 @@
+#include "Profiler.hpp"
+#include "TraceRecorder.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------
+Profiler & Profiler::get() {
+	static Profiler profiler;
+	return profiler;
+}
+
+//----------------------------------------------------------------------------------------
+Profiler::Profiler()
+	: m_frameTimes(HISTORY_SIZE, 0.0f),
+	  m_numFrames(0),
+	  m_isInFrame(false)
+{}
+
+//----------------------------------------------------------------------------------------
+void Profiler::beginFrame() {
+	Clock::time_point now = Clock::now();
+	if (m_numFrames > 0) {
+		float frameMs = chrono::duration<float, milli>(now - m_frameStart).count();
+		m_frameTimes[(m_numFrames - 1) % HISTORY_SIZE] = frameMs;
+	}
+	m_frameStart = now;
+	m_numFrames++;
+	m_isInFrame = true;
+
+	// The slot the new frame reuses starts out empty
+	size_t frame = getCurrentFrame();
+	m_frameTimes[frame] = 0.0f;
+	for (Scope & scope : m_scopes) {
+		scope.history[frame] = 0.0f;
+	}
+
+	collectGpuQueries();
+}
+
+//----------------------------------------------------------------------------------------
+void Profiler::endFrame() {
+	TraceRecorder::get().record("frame", m_frameStart, Clock::now());
+	m_isInFrame = false;
+}
+
+//----------------------------------------------------------------------------------------
+size_t Profiler::getScopeId(const char * name, bool isGpu) {
+	for (size_t i = 0; i < m_scopes.size(); i++) {
+		if (m_scopes[i].isGpu == isGpu && m_scopes[i].name == name) {
+			return i;
+		}
+	}
+
+	Scope scope;
+	scope.name = name;
+	scope.isGpu = isGpu;
+	scope.isStartup = false;
+	scope.depth = 0;
+	scope.startupMs = 0.0f;
+	scope.history.assign(HISTORY_SIZE, 0.0f);
+	m_scopes.push_back(scope);
+
+	GpuQueries queries = { { 0, 0 }, { 0, 0 }, { false, false } };
+	m_gpuQueries.push_back(queries);
+	m_traceNames.push_back(name);
+
+	return m_scopes.size() - 1;
+}
+
+//----------------------------------------------------------------------------------------
+void Profiler::beginScope(size_t scope) {
+	if (m_scopes[scope].isGpu) {
+		GpuQueries & queries = m_gpuQueries[scope];
+		if (queries.queries[0] == 0) {
+			glGenQueries(2, queries.queries);
+		}
+		// Whatever is still pending in this slot is two frames old; drop it
+		// rather than wait for it
+		size_t slot = m_numFrames % 2;
+		queries.frames[slot] = getCurrentFrame();
+		queries.isPending[slot] = m_isInFrame;
+		glBeginQuery(GL_TIME_ELAPSED, queries.queries[slot]);
+		return;
+	}
+
+	m_scopes[scope].depth = int(m_openScopes.size());
+	OpenScope open = { scope, Clock::now() };
+	m_openScopes.push_back(open);
+}
+
+//----------------------------------------------------------------------------------------
+void Profiler::endScope(size_t scope) {
+	if (m_scopes[scope].isGpu) {
+		glEndQuery(GL_TIME_ELAPSED);
+		return;
+	}
+
+	Clock::time_point start = m_openScopes.back().start;
+	Clock::time_point end = Clock::now();
+	float elapsedMs = chrono::duration<float, milli>(end - start).count();
+	m_openScopes.pop_back();
+	TraceRecorder::get().record(m_traceNames[scope], start, end);
+
+	Scope & timed = m_scopes[scope];
+	if (m_isInFrame) {
+		timed.history[getCurrentFrame()] += elapsedMs;
+	}
+	else {
+		timed.isStartup = true;
+		timed.startupMs += elapsedMs;
+	}
+}
+
+//----------------------------------------------------------------------------------------
+void Profiler::collectGpuQueries() {
+	for (size_t i = 0; i < m_gpuQueries.size(); i++) {
+		GpuQueries & queries = m_gpuQueries[i];
+		for (size_t slot = 0; slot < 2; slot++) {
+			if (! queries.isPending[slot]) {
+				continue;
+			}
+			GLint isAvailable = GL_FALSE;
+			glGetQueryObjectiv(queries.queries[slot], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+			if (isAvailable) {
+				GLuint64 elapsedNs = 0;
+				glGetQueryObjectui64v(queries.queries[slot], GL_QUERY_RESULT, &elapsedNs);
+				m_scopes[i].history[queries.frames[slot]] += float(elapsedNs) / 1.0e6f;
+				queries.isPending[slot] = false;
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+const vector<Profiler::Scope> & Profiler::getScopes() const {
+	return m_scopes;
+}
+
+//----------------------------------------------------------------------------------------
+const float * Profiler::getFrameTimes(size_t & out_numFrames, size_t & out_latest) const {
+	// The frame being timed has no time yet
+	out_numFrames = m_numFrames > 1 ? std::min(m_numFrames - 1, HISTORY_SIZE - 1) : 0;
+	out_latest = (m_numFrames + HISTORY_SIZE - 2) % HISTORY_SIZE;
+	return m_frameTimes.data();
+}
+
+//----------------------------------------------------------------------------------------
+size_t Profiler::getCurrentFrame() const {
+	return (m_numFrames + HISTORY_SIZE - 1) % HISTORY_SIZE;
+}
+
+//----------------------------------------------------------------------------------------
+float Profiler::getFrameTimePercentile(float fraction) const {
+	size_t numFrames, latest;
+	getFrameTimes(numFrames, latest);
+	if (numFrames == 0) {
+		return 0.0f;
+	}
+
+	vector<float> times;
+	for (size_t i = 0; i < numFrames; i++) {
+		times.push_back(m_frameTimes[(latest + HISTORY_SIZE - i) % HISTORY_SIZE]);
+	}
+	size_t rank = std::min(size_t(fraction * numFrames), numFrames - 1);
+	nth_element(times.begin(), times.begin() + rank, times.end());
+	return times[rank];
+}
+
+//----------------------------------------------------------------------------------------
+void Profiler::getScopeStats(const Scope & scope, float & out_averageMs,
+		float & out_maxMs) const
+{
+	size_t numFrames, latest;
+	getFrameTimes(numFrames, latest);
+
+	float total = 0.0f;
+	out_maxMs = 0.0f;
+	for (size_t i = 0; i < numFrames; i++) {
+		float ms = scope.history[(latest + HISTORY_SIZE - i) % HISTORY_SIZE];
+		total += ms;
+		out_maxMs = std::max(out_maxMs, ms);
+	}
+	out_averageMs = numFrames > 0 ? total / numFrames : 0.0f;
+}
+
+//----------------------------------------------------------------------------------------
+void Profiler::releaseGpuQueries() {
+	for (GpuQueries & queries : m_gpuQueries) {
+		if (queries.queries[0] != 0) {
+			glDeleteQueries(2, queries.queries);
+		}
+		queries.queries[0] = queries.queries[1] = 0;
+		queries.isPending[0] = queries.isPending[1] = false;
+	}
+}
+
+//----------------------------------------------------------------------------------------
+ProfileScope::ProfileScope(size_t scope)
+	: m_scope(scope)
+{
+	Profiler::get().beginScope(scope);
+}
+
+//----------------------------------------------------------------------------------------
+ProfileScope::~ProfileScope() {
+	Profiler::get().endScope(m_scope);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "cs488-framework/OpenGLImport.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/*
+ * Frame profiler, keeping a rolling history of frame times and of the time
+ * spent in named scopes each frame.
+ *
+ * CPU scopes are timed with a steady clock and may nest.  GPU scopes wrap
+ * GL_TIME_ELAPSED queries, and may not nest, since GL runs only one such query
+ * at a time; each may be timed once per frame.  Each GPU scope alternates
+ * between two queries and reads one back the frame after issuing it, if its
+ * result is ready by then, so timing never stalls the pipeline; GPU times lag
+ * a frame behind.
+ *
+ * Scopes timed outside of a frame, during startup, are kept apart from the
+ * per-frame ones.  The profiler belongs to the thread that owns the GL context.
+ * Time scopes with PROFILE_SCOPE("name") and PROFILE_GPU_SCOPE("name").
+ *
+ * Frames and CPU scopes also go to the TraceRecorder, for a timeline of them;
+ * other threads use TRACE_SCOPE directly.
+ */
+class Profiler {
+public:
+	// Frames kept in the rolling history.
+	static const size_t HISTORY_SIZE = 240;
+
+	struct Scope {
+		std::string name;
+		bool isGpu;
+		bool isStartup;   // timed outside of any frame
+		int depth;        // of nesting among CPU scopes, when last timed
+		float startupMs;  // total time spent in it outside of any frame
+		// Milliseconds spent in the scope during each frame of the history,
+		// indexed like the frame times
+		std::vector<float> history;
+	};
+
+	// The process-wide profiler.
+	static Profiler & get();
+
+	// Bracket every frame; beginFrame() also collects finished GPU queries.
+	void beginFrame();
+	void endFrame();
+
+	// Id of the scope with the given name, registering it on first use.  The
+	// name is traced by pointer, so it must be a string literal.
+	size_t getScopeId(const char * name, bool isGpu);
+	void beginScope(size_t scope);
+	void endScope(size_t scope);
+
+	const std::vector<Scope> & getScopes() const;
+	// Milliseconds between the starts of consecutive frames, oldest first;
+	// out_numFrames of them are valid, ending at out_latest.
+	const float * getFrameTimes(size_t & out_numFrames, size_t & out_latest) const;
+	// Index in the histories of the frame being timed.
+	size_t getCurrentFrame() const;
+	// Frame time below which the given fraction of the history falls.
+	float getFrameTimePercentile(float fraction) const;
+	// Average and worst time spent in the scope per frame, over the history.
+	void getScopeStats(const Scope & scope, float & out_averageMs,
+			float & out_maxMs) const;
+
+	// Delete the GL queries; call before the GL context goes away.
+	void releaseGpuQueries();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct OpenScope {
+		size_t scope;
+		Clock::time_point start;
+	};
+
+	struct GpuQueries {
+		GLuint queries[2];
+		size_t frames[2];   // frame each query was issued in
+		bool isPending[2];  // issued, and its result not read yet
+	};
+
+	Profiler();
+	Profiler(const Profiler &);
+	Profiler & operator = (const Profiler &);
+
+	void collectGpuQueries();
+
+	std::vector<Scope> m_scopes;
+	std::vector<GpuQueries> m_gpuQueries; // indexed like m_scopes
+	std::vector<const char *> m_traceNames; // indexed like m_scopes
+	std::vector<OpenScope> m_openScopes;  // CPU scopes, innermost last
+
+	std::vector<float> m_frameTimes;
+	size_t m_numFrames;  // frames timed so far
+	bool m_isInFrame;
+	Clock::time_point m_frameStart;
+};
+
+// RAII timers for the scopes in PROFILE_SCOPE and PROFILE_GPU_SCOPE.
+class ProfileScope {
+public:
+	explicit ProfileScope(size_t scope);
+	~ProfileScope();
+
+private:
+	size_t m_scope;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+// Time the rest of the enclosing block on the CPU.
+#define PROFILE_SCOPE(name) \
+	static const size_t PROFILE_CONCAT(profileScopeId, __LINE__) = \
+			Profiler::get().getScopeId(name, false); \
+	ProfileScope PROFILE_CONCAT(profileScope, __LINE__)( \
+			PROFILE_CONCAT(profileScopeId, __LINE__))
+
+// Time the GL commands issued in the rest of the enclosing block on the GPU.
+#define PROFILE_GPU_SCOPE(name) \
+	static const size_t PROFILE_CONCAT(profileGpuScopeId, __LINE__) = \
+			Profiler::get().getScopeId(name, true); \
+	ProfileScope PROFILE_CONCAT(profileGpuScope, __LINE__)( \
+			PROFILE_CONCAT(profileGpuScopeId, __LINE__))
@@ -9,6 +9,7 @@ using glm::value_ptr;
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 using namespace std;
 
 //------------------------------------------------------------------------------------
@@ -134,9 +135,48 @@ void ShaderProgram::link() {
     glLinkProgram(programObject);
     checkLinkStatus();
 
+    cacheUniformLocations();
+
     CHECK_GL_ERRORS;
 }
 
+//------------------------------------------------------------------------------------
+/*
+ * Looks up the location of every active uniform once, so that
+ * getUniformLocation() does not need to query the driver each time.
+ */
+void ShaderProgram::cacheUniformLocations() {
+    uniformLocations.clear();
+
+    GLint numUniforms = 0;
+    glGetProgramiv(programObject, GL_ACTIVE_UNIFORMS, &numUniforms);
+    GLint maxNameLength = 0;
+    glGetProgramiv(programObject, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    vector<GLchar> name(maxNameLength + 1);
+    for (GLint i = 0; i < numUniforms; ++i) {
+        GLsizei nameLength = 0;
+        GLint size = 0;
+        GLenum type;
+        glGetActiveUniform(programObject, i, (GLsizei)name.size(), &nameLength,
+                &size, &type, name.data());
+
+        GLint location = glGetUniformLocation(programObject, name.data());
+        if (location == -1) {
+            continue; // Member of a uniform block; has no location.
+        }
+
+        string uniformName(name.data(), nameLength);
+        uniformLocations[uniformName] = location;
+
+        // Arrays are reported as "name[0]", but may be looked up as "name".
+        size_t bracket = uniformName.rfind("[0]");
+        if (bracket != string::npos && bracket + 3 == uniformName.size()) {
+            uniformLocations[uniformName.substr(0, bracket)] = location;
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------
 ShaderProgram::~ShaderProgram() {
     deleteShaders();
@@ -244,6 +284,12 @@ GLuint ShaderProgram::getProgramObject() const {
 GLint ShaderProgram::getUniformLocation (
 		const char * uniformName
 ) const {
+    auto cached = uniformLocations.find(uniformName);
+    if (cached != uniformLocations.end()) {
+        return cached->second;
+    }
+
+    // Not cached, e.g. an element of an array other than the first.
     GLint result = glGetUniformLocation(programObject, (const GLchar *)uniformName);
 
     if (result == -1) {
@@ -273,3 +319,23 @@ GLint ShaderProgram::getAttribLocation (
     return result;
 }
 
+//------------------------------------------------------------------------------------
+/*
+ * Connects the uniform block named 'blockName' to the uniform buffer binding
+ * point 'bindingPoint', so that it reads from whichever buffer is bound there.
+ */
+void ShaderProgram::bindUniformBlock (
+		const char * blockName,
+		GLuint bindingPoint
+) {
+    GLuint blockIndex = glGetUniformBlockIndex(programObject, (const GLchar *)blockName);
+
+    if (blockIndex == GL_INVALID_INDEX) {
+        stringstream errorMessage;
+        errorMessage << "Error obtaining uniform block index: " << blockName;
+        throw ShaderException(errorMessage.str());
+    }
+
+    glUniformBlockBinding(programObject, blockIndex, bindingPoint);
+    CHECK_GL_ERRORS;
+}
@@ -7,6 +7,7 @@
 #include "OpenGLImport.hpp"
 
 #include <string>
+#include <unordered_map>
 
 
 class ShaderProgram {
@@ -37,6 +38,8 @@ public:
 
     GLint getAttribLocation(const char * attributeName) const;
 
+    void bindUniformBlock(const char * blockName, GLuint bindingPoint);
+
 
 private:
     struct Shader {
@@ -54,6 +57,9 @@ private:
     GLuint prevProgramObject;
     GLuint activeProgram;
 
+    // Uniform name -> location, filled in by link().
+    std::unordered_map<std::string, GLint> uniformLocations;
+
     void extractSourceCode(std::string & shaderSource, const std::string & filePath);
     
     void extractSourceCodeAndCompile(const Shader &shader);
@@ -66,6 +72,8 @@ private:
 
     void checkLinkStatus();
 
+    void cacheUniformLocations();
+
     void deleteShaders();
 };
 
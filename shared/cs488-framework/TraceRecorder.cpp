@@ -0,0 +1,159 @@
+#include "TraceRecorder.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+
+thread_local TraceRecorder::ThreadBuffer * TraceRecorder::s_threadBuffer = nullptr;
+
+//----------------------------------------------------------------------------------------
+/*
+ * Event names are string literals, but may still hold quotes or backslashes.
+ */
+static void writeJsonString(ostream & out, const char * text) {
+	out << '"';
+	for (const char * c = text; *c != '\0'; c++) {
+		if (*c == '"' || *c == '\\') {
+			out << '\\' << *c;
+		} else if ((unsigned char)(*c) < 0x20) {
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int)(*c));
+			out << escaped;
+		} else {
+			out << *c;
+		}
+	}
+	out << '"';
+}
+
+//----------------------------------------------------------------------------------------
+TraceRecorder & TraceRecorder::get() {
+	static TraceRecorder recorder;
+	return recorder;
+}
+
+//----------------------------------------------------------------------------------------
+TraceRecorder::TraceRecorder()
+	: m_epoch(Clock::now())
+{}
+
+//----------------------------------------------------------------------------------------
+TraceRecorder::ThreadBuffer & TraceRecorder::getThreadBuffer() {
+	if (s_threadBuffer == nullptr) {
+		unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+		buffer->startup.reserve(STARTUP_EVENTS);
+		buffer->numRingEvents = 0;
+
+		lock_guard<mutex> lock(m_mutex);
+		buffer->id = m_threads.size() + 1;
+		s_threadBuffer = buffer.get();
+		m_threads.push_back(move(buffer));
+	}
+	return *s_threadBuffer;
+}
+
+//----------------------------------------------------------------------------------------
+void TraceRecorder::setThreadName(const string & name) {
+	ThreadBuffer & buffer = getThreadBuffer();
+	lock_guard<mutex> lock(buffer.mutex);
+	buffer.name = name;
+}
+
+//----------------------------------------------------------------------------------------
+void TraceRecorder::record(const char * name, Clock::time_point start,
+		Clock::time_point end)
+{
+	ThreadBuffer & buffer = getThreadBuffer();
+	Event event = { name, start, end };
+
+	lock_guard<mutex> lock(buffer.mutex);
+	if (buffer.startup.size() < STARTUP_EVENTS) {
+		buffer.startup.push_back(event);
+		return;
+	}
+	if (buffer.ring.size() < RING_EVENTS) {
+		buffer.ring.push_back(event);
+	} else {
+		buffer.ring[buffer.numRingEvents % RING_EVENTS] = event;
+	}
+	buffer.numRingEvents++;
+}
+
+//----------------------------------------------------------------------------------------
+/*
+ * Every event becomes a complete ("X") event on its thread's track, with
+ * timestamps in microseconds; thread names go in metadata ("M") events.
+ */
+void TraceRecorder::write(ostream & out) {
+	vector<ThreadBuffer *> threads;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		for (const unique_ptr<ThreadBuffer> & buffer : m_threads) {
+			threads.push_back(buffer.get());
+		}
+	}
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool isFirst = true;
+	vector<Event> events;
+	for (ThreadBuffer * buffer : threads) {
+		string threadName;
+		{
+			// Copy out, so the thread is held up no longer than that
+			lock_guard<mutex> lock(buffer->mutex);
+			events = buffer->startup;
+			events.insert(events.end(), buffer->ring.begin(), buffer->ring.end());
+			threadName = buffer->name;
+		}
+
+		// Scopes are recorded as they end; the viewer nests them best in
+		// order of start, outer scopes first
+		sort(events.begin(), events.end(), [] (const Event & a, const Event & b) {
+			return a.start < b.start || (a.start == b.start && a.end > b.end);
+		});
+
+		if (! threadName.empty()) {
+			out << (isFirst ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\","
+				<< "\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":";
+			writeJsonString(out, threadName.c_str());
+			out << "}}";
+			isFirst = false;
+		}
+
+		char times[64];
+		for (const Event & event : events) {
+			double startUs = chrono::duration<double, micro>(event.start - m_epoch).count();
+			double durationUs = chrono::duration<double, micro>(event.end - event.start).count();
+			snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f", startUs, durationUs);
+
+			out << (isFirst ? "" : ",") << "\n{\"name\":";
+			writeJsonString(out, event.name);
+			out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id << "," << times << "}";
+			isFirst = false;
+		}
+	}
+	out << "\n]}\n";
+}
+
+//----------------------------------------------------------------------------------------
+bool TraceRecorder::dump(const string & filePath) {
+	ofstream file(filePath.c_str());
+	if (! file) {
+		return false;
+	}
+	write(file);
+	return bool(file);
+}
+
+//----------------------------------------------------------------------------------------
+TraceScope::TraceScope(const char * name)
+	: m_name(name),
+	  m_start(TraceRecorder::Clock::now())
+{}
+
+//----------------------------------------------------------------------------------------
+TraceScope::~TraceScope() {
+	TraceRecorder::get().record(m_name, m_start, TraceRecorder::Clock::now());
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+ * Records timed scopes from any thread, for dumping as Chrome trace_event JSON
+ * (load the file in chrome://tracing or ui.perfetto.dev for a flame chart).
+ *
+ * Each thread records into buffers of its own: the first STARTUP_EVENTS events
+ * it records are kept for good, so startup always makes it into the dump, and
+ * after those a ring keeps its latest RING_EVENTS.  Recording an event costs a
+ * clock read and the lock of the thread's own buffers, which is only ever
+ * contended while a dump copies them.
+ *
+ * Event names are kept by pointer and must outlive the recorder; pass string
+ * literals.  Time scopes with TRACE_SCOPE("name"); the CPU scopes of the
+ * Profiler are recorded as well.
+ */
+class TraceRecorder {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	static const size_t STARTUP_EVENTS = 4096;
+	static const size_t RING_EVENTS = 16384;
+
+	// The process-wide recorder.
+	static TraceRecorder & get();
+
+	// Name the calling thread in dumps; unnamed threads are numbered.
+	void setThreadName(const std::string & name);
+
+	// Record that the calling thread spent [start, end] in the named scope.
+	void record(const char * name, Clock::time_point start, Clock::time_point end);
+
+	// Write every event recorded so far as trace_event JSON.
+	void write(std::ostream & out);
+	// Same, to a file; returns false if it can't be written.
+	bool dump(const std::string & filePath);
+
+private:
+	struct Event {
+		const char * name;
+		Clock::time_point start;
+		Clock::time_point end;
+	};
+
+	struct ThreadBuffer {
+		std::mutex mutex;  // guards everything below
+		size_t id;
+		std::string name;
+		std::vector<Event> startup;
+		std::vector<Event> ring;
+		size_t numRingEvents;  // recorded into the ring so far
+	};
+
+	TraceRecorder();
+	TraceRecorder(const TraceRecorder &);
+	TraceRecorder & operator = (const TraceRecorder &);
+
+	ThreadBuffer & getThreadBuffer();
+
+	// The calling thread's buffers, once it has recorded anything
+	static thread_local ThreadBuffer * s_threadBuffer;
+
+	Clock::time_point m_epoch;  // trace timestamps count from here
+
+	std::mutex m_mutex;  // guards m_threads
+	// Kept after their threads exit, so their events still get dumped
+	std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+};
+
+// RAII timer for TRACE_SCOPE.
+class TraceScope {
+public:
+	explicit TraceScope(const char * name);
+	~TraceScope();
+
+private:
+	const char * m_name;
+	TraceRecorder::Clock::time_point m_start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+// Record the rest of the enclosing block in the trace; safe on any thread.
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)